@@ -2,53 +2,67 @@
 #include "DSC.h"
 #include "DSC_Constants.h"
 #include "DSC_Globals.h"
+#include "DSC_Strings.h"
 #include <TextBuffer.h>
 
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#endif
+
 /// ----- GLOBAL VARIABLES -----
 /*
  * The existence of global variables are "declared" in DSC_Global.h, so that each 
  * source file that includes the header knows about them. The variables must then be
  * “defined” once in one of the source files (this one).
 
- * The following structure contains all of the global variables used by the ISR to 
- * communicate with the DSC.clkCalled() object. You cannot pass parameters to an 
- * ISR so these values must be global. The fields are defined in DSC_Globals.h
+ * The following pool holds the state used by each DSC object and its ISR. You cannot
+ * pass parameters to an ISR, so each object takes a slot, and the ISR trampoline of 
+ * that slot calls the object's clkCalled(). The fields are defined in DSC_Globals.h
  */
-dscGlobal_t dscGlobal;
+dscGlobal_t dscState[DSC_INSTANCES];
+dscGlobal_t &dscGlobal = dscState[0];
 
-// ----- Input/Output Pins (Global) -----
-byte CLK;         // Keybus Yellow (Clock Line)
-byte DTA_IN;      // Keybus Green (Data Line via V divider)
-byte DTA_OUT;     // Keybus Green Output (Data Line through driver)
-byte LED;         // LED pin on the arduino
+DSC *DSC::instances[DSC_INSTANCES];
+byte DSC::instanceCount = 0;
+void (* const DSC::clkHandlers[4])(void) = 
+  { DSC::clkCalled0, DSC::clkCalled1, DSC::clkCalled2, DSC::clkCalled3 };
 
-void clkCalled_Handler(); // Prototype for interrupt handler, called on clock line change
+// The word and message Strings of dscGlobal_t, the WORD_STRINGS words first
+static String dscGlobal_t::* const stringFields[STRING_FIELDS] =
+  { &dscGlobal_t::pBuild, &dscGlobal_t::pWord, &dscGlobal_t::oldPWord,
+    &dscGlobal_t::kBuild, &dscGlobal_t::kWord, &dscGlobal_t::oldKWord,
+    &dscGlobal_t::pMsg, &dscGlobal_t::kMsg };
 
-TextBuffer tempByte(12);        // Initialize TextBuffer.h for temp byte buffer 
-TextBuffer pInfo(WORD_BITS);    // Initialize TextBuffer.h for panel info
-TextBuffer kInfo(WORD_BITS);    // Initialize TextBuffer.h for keypad info
+void clearTiming(dscTiming_t &t);
+void clearBus(dscBus_t &b);
+void addBus(dscBus_t &b, const dscTiming_t &t);
+void resetGap(dscGap_t &e);
+void learnGap(dscGlobal_t &g, unsigned long intv, bool gap);
 
 /// --- END GLOBAL VARIABLES ---
 
-DSC::DSC(void)
+DSC::DSC(void) :
+  dscGlobal(dscState[(instanceCount < DSC_INSTANCES) ? instanceCount : (DSC_INSTANCES - 1)]),
+  tempByte(12),         // Initialize TextBuffer.h for temp byte buffer 
+  pInfo(WORD_BITS),     // Initialize TextBuffer.h for panel info
+  kInfo(WORD_BITS)      // Initialize TextBuffer.h for keypad info
   {
-    // ----- Time Variables -----
-    // Volatile variables, modified within ISR, based on micros()
-    dscGlobal.intervalTimer = 0;   
-    dscGlobal.clockChange = 0;
-    dscGlobal.lastChange = 0;      
-    dscGlobal.lastRise = 0;         // NOT USED YET
-    dscGlobal.lastFall = 0;         // NOT USED YET
-    dscGlobal.newWord = false;      // NOT USED YET
-    
-    // Time variables, based on millis()
-    dscGlobal.lastStatus = 0;
-    dscGlobal.lastData = 0;
+    // ----- Instance Slot -----
+    // Objects past DSC_INSTANCES have no slot: their reference points at the last
+    // slot (it has to point somewhere) but they never write to it, begin() fails
+    // and process() does nothing, so the object that owns the slot keeps working
+    if (instanceCount < DSC_INSTANCES) {
+      slot = instanceCount++;
+      instances[slot] = this;
+    }
+    else slot = DSC_INSTANCES;
 
     // Class level variables to hold time elements
-    int yy = 0, mm = 0, dd = 0, HH = 0, MM = 0, SS = 0;
-    bool timeAvailable = false;     // Changes to true when kCmd == 0xa5 to 
+    yy = 0, mm = 0, dd = 0, HH = 0, MM = 0, SS = 0;
+    timeAvailable = false;          // Changes to true when pCmd == 0xa5 to 
                                     // indicate that the time elements are valid
+    panelTime = 0;
+    clockChanged = false;           // True when a 0xa5 word moved panelTime
 
     // ----- Input/Output Pins (DEFAULTS) ------
     //   These can be changed prior to DSC.begin() using functions below
@@ -56,14 +70,61 @@ DSC::DSC(void)
     DTA_IN   = 4;    // Keybus Green (Data Line via V divider)
     DTA_OUT  = 8;    // Keybus Green Output (Data Line through driver)
     LED      = 13;   // LED pin on the arduino
+    ledState = 0xff; // Unknown, forces the first LED write in process()
+
+    // ----- Events -----
+    criticalFn = NULL;
+    queue = NULL;
+    recorder = NULL;
+
+    clearFilter(EVT_PANEL);
+    clearFilter(EVT_KEYPAD);
+    for (byte i=0;i<STRING_FIELDS;i++) strBuf[i] = NULL;
+    busStart = 0;
+    memset(&busLast, 0, sizeof(dscBus_t));
+    busCarry = 0;
+    critKey[0] = 0, critKey[1] = 0;     // No command is 0x00, so 0 is "none"
+    critSeen[0] = 0, critSeen[1] = 0;
+
+    if (slot < DSC_INSTANCES) initState();
+  }
+
+void DSC::initState(void)
+  {
+    // ----- Time Variables -----
+    // Volatile variables, modified within ISR, based on micros()
+    dscGlobal.intervalTimer = 0;   
+    dscGlobal.clockChange = 0;
+    dscGlobal.lastChange = 0;      
+    dscGlobal.lastRise = 0;
+    dscGlobal.lastFall = 0;
+    clearTiming(dscGlobal.tBuild);
+    clearTiming(dscGlobal.tWord);
+    dscGlobal.newTiming = false;
+    dscGlobal.newWord = false;      // Set by the ISR when a new word gap is seen
+    dscGlobal.gapEst.thresh = NEW_WORD_INTV - 200;  // Until the gap is learned
+    resetGap(dscGlobal.gapEst);
+    dscGlobal.gapEst.relearns = 0;
+    clearBus(dscGlobal.bus);
+    dscGlobal.busOn = false;        // Set by analyze()
+    
+    // Time variables, based on millis()
+    dscGlobal.lastStatus = 0;
+    dscGlobal.lastData = 0;
 
     // ----- Keybus Word String Vars -----
-    dscGlobal.pBuild="", dscGlobal.pWord="";
-    dscGlobal.oldPWord="", dscGlobal.pMsg="";
-    dscGlobal.kBuild="", dscGlobal.kWord="";
-    dscGlobal.oldKWord="", dscGlobal.kMsg="";
+    // The Strings are cleared in begin(): a global DSC object can be constructed
+    // before dscState (another file), when its Strings aren't constructed yet
     dscGlobal.pCmd = 0, dscGlobal.kCmd = 0;
 
+    // ----- Decoded Panel State -----
+    dscGlobal.pStatus = 0;
+    for (byte i=0;i<ZONE_GROUPS;i++) dscGlobal.zones[i] = 0;
+    dscGlobal.armState = 0, dscGlobal.armUser = 0;
+    dscGlobal.kSlots = 0, dscGlobal.kInvalid = 0;
+    dscGlobal.pFiltered = 0, dscGlobal.kFiltered = 0;
+    dscGlobal.strAllocs = 0, dscGlobal.strFails = 0;
+
     // ----- Byte Array Variables -----
     //dscGlobal.pBytes[ARR_SIZE] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0};    // NOT USED
     //dscGlobal.kBytes[ARR_SIZE] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0};    // NOT USED
@@ -71,10 +132,13 @@ DSC::DSC(void)
 
 int DSC::addSerial(void)
   {
+    return 0;                     // return failure (not implemented)
   }
 
-void DSC::begin(void)
+int DSC::begin(void)
   {
+    if (slot >= DSC_INSTANCES) return 0;  // return failure, no free slot
+    
     pinMode(CLK, INPUT);
     pinMode(DTA_IN, INPUT);
     pinMode(DTA_OUT, OUTPUT);
@@ -84,75 +148,144 @@ void DSC::begin(void)
     pInfo.begin();            // Begin the panel info buffer, allocate memory
     kInfo.begin();            // Begin the keypad info buffer, allocate memory
 
+    // Reserve the String buffers before the ISR starts, so it never allocates
+    // (heap use inside an ISR can corrupt the heap the main loop is using)
+    for (byte i=0;i<STRING_FIELDS;i++) {
+      String &str = dscGlobal.*stringFields[i];
+      str = "";
+      if (!str.reserve((i < WORD_STRINGS) ? MAX_BITS + 1 : MSG_RESERVE)) {
+        if (dscGlobal.strFails < 0xff) dscGlobal.strFails++;
+      }
+    }
+    countAllocs();
+
     // Set the interrupt pin
     intrNum = digitalPinToInterrupt(CLK);
+    if (intrNum == (uint8_t)NOT_AN_INTERRUPT) return 0;   // return failure
 
-    // Attach interrupt on the CLK pin
-    attachInterrupt(intrNum, clkCalled_Handler, CHANGE);  
+    // Attach interrupt on the CLK pin, through this slot's trampoline
+    attachInterrupt(intrNum, clkHandlers[slot], CHANGE);  
     //   Changed from RISING to CHANGE to read both panel and keypad data
+    return 1;                 // return success
   }
 
+/* These are the interrupt trampolines, one per slot. attachInterrupt() can only call
+ * a plain function, so each one calls the clkCalled() of the object in its slot.
+ * Slots past DSC_INSTANCES are never attached.
+ */
+void DSC::clkCalled0(void) { instances[0]->clkCalled(); }
+void DSC::clkCalled1(void) { instances[(DSC_INSTANCES > 1) ? 1 : 0]->clkCalled(); }
+void DSC::clkCalled2(void) { instances[(DSC_INSTANCES > 2) ? 2 : 0]->clkCalled(); }
+void DSC::clkCalled3(void) { instances[(DSC_INSTANCES > 3) ? 3 : 0]->clkCalled(); }
+
 /* This is the interrupt handler used by this class. It is called every time the input
  * pin changes from high to low or from low to high.
- *
- * The function is not a member of the DSC class, it must be in the global scope in order 
- * to be called by attachInterrupt() from within the DSC class.
  */
-void clkCalled_Handler()
+void DSC::clkCalled(void)
   {
     dscGlobal.clockChange = micros();                   // Save the current clock change time
     dscGlobal.intervalTimer = 
         (dscGlobal.clockChange - dscGlobal.lastChange); // Determine interval since last clock change
 
-    // If the interval is longer than the required amount (NEW_WORD_INTV - 200 us)
-    if (dscGlobal.intervalTimer > (NEW_WORD_INTV - 200)) {
+    // If the interval is longer than the gap threshold (learned, NEW_WORD_INTV - 200 us
+    // until then), this is the new word gap
+    bool gap = (dscGlobal.intervalTimer > dscGlobal.gapEst.thresh);
+    learnGap(dscGlobal, dscGlobal.intervalTimer, gap);
+    if (gap) {
       dscGlobal.kWord = dscGlobal.kBuild;               // Save the complete keypad raw data bytes sentence
       dscGlobal.kBuild = "";                            // Reset the raw data bytes keypad word being built
+      dscGlobal.newWord = true;                         // Flag the new word (wakes DSC.idle())
+
+      dscGlobal.tBuild.gap = dscGlobal.intervalTimer;   // Save the complete word's timing
+      dscGlobal.tWord = dscGlobal.tBuild;
+      if (dscGlobal.busOn) addBus(dscGlobal.bus, dscGlobal.tBuild);
+      clearTiming(dscGlobal.tBuild);                    // Reset the timing of the word being built
+      dscGlobal.newTiming = true;
+    }
+    else {
+      // Accumulate the clock half period into the timing of the word being built
+      dscTiming_t &t = dscGlobal.tBuild;
+      unsigned int intv = dscGlobal.intervalTimer;
+      t.edges++;
+      t.sumIntv += intv;
+      if (intv < t.minIntv) t.minIntv = intv;
+      if (intv > t.maxIntv) t.maxIntv = intv;
+      byte bin = intv >> TIMING_BIN_SHIFT;
+      if (bin >= TIMING_BINS) bin = TIMING_BINS - 1;    // Last bin holds everything longer
+      if (t.hist[bin] < 0xff) t.hist[bin]++;
     }
     dscGlobal.lastChange = dscGlobal.clockChange;       // Re-save the current change time as last change time
 
     // If clock line is going HIGH, this is PANEL data
+    byte clk, dta;
     if (digitalRead(CLK)) {                
+      clk = 1;
       dscGlobal.lastRise = dscGlobal.lastChange;        // Set the lastRise time
+      //delayMicroseconds(120);           // Delay for 120 us to get a valid data line read
+      dta = digitalRead(DTA_IN);
       if (dscGlobal.pBuild.length() <= MAX_BITS) {      // Limit the string size to something manageable
-        //delayMicroseconds(120);           // Delay for 120 us to get a valid data line read
-        if (digitalRead(DTA_IN)) dscGlobal.pBuild += "1"; 
+        if (dta) dscGlobal.pBuild += "1"; 
         else dscGlobal.pBuild += "0";
       }
+      else if (dscGlobal.gapEst.state == GAP_TRACK) {
+        resetGap(dscGlobal.gapEst);                     // Gaps are being missed, learn again
+        if (dscGlobal.gapEst.relearns < 0xff) dscGlobal.gapEst.relearns++;
+      }
     }
     // Otherwise, it's going LOW, this is KEYPAD data
     else {                                  
+      clk = 0;
       dscGlobal.lastFall = dscGlobal.lastChange;          // Set the lastFall time
+      if (!gap)                                           // Add the clock high time (not the gap)
+        dscGlobal.tBuild.highTime += dscGlobal.lastFall - dscGlobal.lastRise;
+      //delayMicroseconds(200);           // Delay for 300 us to get a valid data line read
+      dta = digitalRead(DTA_IN);
+      if (!dta && dscGlobal.busOn) dscGlobal.bus.keypadBits++;  // A keypad pulls the line low
       if (dscGlobal.kBuild.length() <= MAX_BITS) {        // Limit the string size to something manageable 
-        //delayMicroseconds(200);           // Delay for 300 us to get a valid data line read
-        if (digitalRead(DTA_IN)) dscGlobal.kBuild += "1"; 
+        if (dta) dscGlobal.kBuild += "1"; 
         else dscGlobal.kBuild += "0";
       }
     }
+
+    // Hand the edge to the capture recorder, if one is recording
+    if (recorder) recorder->edge(dscGlobal.clockChange, clk, dta);
   }
 
 int DSC::process(void)
   {
+    if (slot >= DSC_INSTANCES) return 0;  // return failure, no slot (see DSC())
+    
     // ------------ Get/process incoming data -------------
     dscGlobal.pCmd = 0, 
     dscGlobal.kCmd = 0; 
     timeAvailable = false;      // Set the time element status to invalid
+    clockChanged = false;
+    dscGlobal.newWord = false;  // Consume the new word flag set by the ISR
     
     // ----------------- Turn on/off LED ------------------
-    if ((millis() - dscGlobal.lastStatus) > 500)
-      digitalWrite(LED, 0);     // Turn LED OFF (no recent status command [0x05])
-    else
-      digitalWrite(LED, 1);     // Turn LED ON  (recent status command [0x05])
+    // LED is ON if there was a recent status command [0x05], OFF if not.
+    // Only written on a change, the pin doesn't need refreshing every call
+    byte ledOn = ((millis() - dscGlobal.lastStatus) > 500) ? 0 : 1;
+    if (ledOn != ledState) {
+      digitalWrite(LED, ledOn);
+      ledState = ledOn;
+    }
     
     /*
-     * The normal clock frequency is 1 Hz or one cycle every ms (1000 us) 
-     * The new word marker is clock high for about 15 ms (15000 us)
-     * If the interval is longer than the required amount (NEW_WORD_INTV + 200 us), 
-     * and the panel word in progress (pBuild) is more than 8 characters long,
-     * process the panel and keypad words, otherwise return failure (0).
+     * The normal clock frequency is about 1 kHz, one cycle every ms (1000 us), so a
+     * clock half period is about 500 us. The new word marker is the clock held high
+     * for a few ms, at least 5.2 ms (NEW_WORD_INTV) on the panels seen so far.
+     * If the last interval is longer than the gap threshold the ISR uses (learned
+     * from the bus, see dscGap_t), and the panel word in progress (pBuild) is at
+     * least 8 characters long, process the panel and keypad words, otherwise 
+     * return failure (0).
      */
-    if ((dscGlobal.intervalTimer < (NEW_WORD_INTV + 200)) || 
-            (dscGlobal.pBuild.length() < 8)) return 0;  // Return failure
+    noInterrupts();
+    unsigned long intv = dscGlobal.intervalTimer;
+    unsigned long thresh = dscGlobal.gapEst.thresh;
+    interrupts();
+    if ((intv <= thresh) || (dscGlobal.pBuild.length() < 8)) return 0;  // Return failure
+    if (dscGlobal.busOn && dscGlobal.bus.taken < 0xffff) dscGlobal.bus.taken++;
 
     dscGlobal.pWord = dscGlobal.pBuild;   // Save the complete panel raw data bytes sentence
     dscGlobal.pBuild = "";                // Reset the raw data panel word being built
@@ -162,8 +295,32 @@ int DSC::process(void)
     dscGlobal.kMsg = "";                  // Initialize keypad message for output 
     //dscGlobal.kCmd = 0;
     
-    dscGlobal.pCmd = decodePanel();       // Decode the panel binary, return command byte, or 0
-    dscGlobal.kCmd = decodeKeypad();      // Decode the keypad binary, return command byte, or 0
+    // Alarm-critical words are handed over first, before any decoding/formatting
+    byte critical = dispatchCritical();
+    
+    // Filtered commands (setFilter()) are dropped here, before any decoding, but
+    // are still recorded as seen (duplicates, no data timer, LED)
+    byte cmd = binToInt(dscGlobal.pWord,0,8);
+    if (allowed(EVT_PANEL, cmd))
+      dscGlobal.pCmd = decodePanel();     // Decode the panel binary, return command byte, or 0
+    else {
+      if (cmd && dscGlobal.pWord != dscGlobal.oldPWord) markWord(EVT_PANEL, cmd);
+      if (dscGlobal.pFiltered < 0xffff) dscGlobal.pFiltered++;
+    }
+    cmd = binToInt(dscGlobal.kWord,0,8);
+    if (allowed(EVT_KEYPAD, cmd))
+      dscGlobal.kCmd = decodeKeypad();    // Decode the keypad binary, return command byte, or 0
+    else {
+      if (dscGlobal.kWord.indexOf("0") != -1) markWord(EVT_KEYPAD, cmd);
+      if (dscGlobal.kFiltered < 0xffff) dscGlobal.kFiltered++;
+    }
+    countAllocs();
+    
+    // Routine words are deferred to the event queue (coalesced there)
+    if (dscGlobal.pCmd && !(critical & EVT_PANEL))
+      raise(EVT_PANEL, dscGlobal.pCmd, binToInt(dscGlobal.pWord,9,8), false);
+    if (dscGlobal.kCmd && !(critical & EVT_KEYPAD))
+      raise(EVT_KEYPAD, dscGlobal.kCmd, binToInt(dscGlobal.kWord,8,8), false);
     
     if (dscGlobal.pCmd && dscGlobal.kCmd) return 3;  // Return 3 if both were decoded
     else if (dscGlobal.kCmd) return 2;    // Return 2 if keypad word was decoded
@@ -171,10 +328,360 @@ int DSC::process(void)
     else return 0;                        // Return failure if none were decoded
   }
 
+void DSC::setFilter(byte src, const byte *allow, byte allowCount, 
+                    const byte *deny, byte denyCount)
+  {
+    byte *mask = (src == EVT_KEYPAD) ? kFilter : pFilter;
+    // Starts from nothing passing if there is an allow list, everything if not
+    memset(mask, (allow && allowCount) ? 0x00 : 0xff, 32);
+    for (byte i=0;allow && i<allowCount;i++)
+      mask[allow[i] >> 3] |= (1 << (allow[i] & 7));
+    for (byte i=0;deny && i<denyCount;i++)
+      mask[deny[i] >> 3] &= ~(1 << (deny[i] & 7));
+  }
+
+void DSC::clearFilter(byte src)
+  {
+    memset((src == EVT_KEYPAD) ? kFilter : pFilter, 0xff, 32);
+  }
+
+int DSC::allowed(byte src, byte cmd)
+  {
+    const byte *mask = (src == EVT_KEYPAD) ? kFilter : pFilter;
+    return (mask[cmd >> 3] >> (cmd & 7)) & 1;
+  }
+
+void DSC::countAllocs(void)
+  {
+    // The ISR can replace pBuild/kBuild (and kWord), read the buffers with it off
+    noInterrupts();
+    for (byte i=0;i<STRING_FIELDS;i++) {
+      const char *buf = (dscGlobal.*stringFields[i]).c_str();
+      if (buf != strBuf[i]) {
+        strBuf[i] = buf;
+        dscGlobal.strAllocs++;
+      }
+    }
+    interrupts();
+  }
+
+void DSC::onCritical(void (*fn)(const dscEvent_t &evt))
+  {
+    criticalFn = fn;
+  }
+
+void DSC::setQueue(DSCEventQueue &q)
+  {
+    queue = &q;
+  }
+
+void DSC::setRecorder(DSCRecorder *r)
+  {
+    recorder = r;
+  }
+
+byte DSC::dispatchCritical(void)
+  {
+    // Only looks at the command byte (and the arm bits of 0xa5), using the same
+    // "new word" checks as decodePanel() and decodeKeypad(). The panel repeats its
+    // state words in between other words, so a changed word isn't enough: an
+    // event is handed over once, repeats of it are still critical (kept off the
+    // routine queue) but not raised again (newCritical())
+    byte critical = 0;
+    
+    byte cmd = binToInt(dscGlobal.pWord,0,8);
+    if (cmd && dscGlobal.pWord != dscGlobal.oldPWord) {
+      byte data = (cmd == 0xa5) ? binToInt(dscGlobal.pWord,41,2) : binToInt(dscGlobal.pWord,9,8);
+      if (dscCritical(EVT_PANEL, cmd, data)) {
+        if (newCritical(EVT_PANEL, cmd, data)) raise(EVT_PANEL, cmd, data, true);
+        critical |= EVT_PANEL;
+      }
+    }
+    
+    if (dscGlobal.kWord.indexOf("0") != -1) {
+      cmd = binToInt(dscGlobal.kWord,0,8);
+      byte data = binToInt(dscGlobal.kWord,8,8);
+      if (dscCritical(EVT_KEYPAD, cmd, data)) {
+        if (newCritical(EVT_KEYPAD, cmd, data)) raise(EVT_KEYPAD, cmd, data, true);
+        critical |= EVT_KEYPAD;
+      }
+    }
+    return critical;
+  }
+
+int DSC::newCritical(byte src, byte cmd, byte data)
+  {
+    byte i = (src == EVT_KEYPAD) ? 1 : 0;
+    unsigned int key = ((unsigned int)cmd << 8) | data;
+    unsigned long now = millis();
+    int repeat = (key == critKey[i] && (now - critSeen[i]) < EVT_REPEAT_MS);
+    critKey[i] = key;
+    critSeen[i] = now;          // The window runs from the last time it was seen
+    return !repeat;
+  }
+
+void DSC::markWord(byte src, byte cmd)
+  {
+    dscGlobal.lastData = millis();              // Record the time (last data word was received)
+    if (src == EVT_KEYPAD) {
+      dscGlobal.oldKWord = dscGlobal.kWord;
+      return;
+    }
+    dscGlobal.oldPWord = dscGlobal.pWord;
+    if (cmd == 0x05) dscGlobal.lastStatus = millis();   // Record the time for LED logic
+  }
+
+void DSC::raise(byte src, byte cmd, byte data, bool critical)
+  {
+    dscEvent_t evt;
+    evt.src = src;
+    evt.cmd = cmd;
+    evt.data = data;
+    evt.time = millis();
+    
+    if (critical && criticalFn) criticalFn(evt);    // Notify right away
+    else if (queue) queue->push(evt, critical);
+  }
+
+void clearTiming(dscTiming_t &t)
+  {
+    // Resets a word timing record, called from the ISR (keep it short)
+    memset(&t, 0, sizeof(dscTiming_t));
+    t.minIntv = 0xffff;
+  }
+
+void resetGap(dscGap_t &e)
+  {
+    // Starts learning the gap threshold again, the current threshold stays in use
+    e.longest = 0;
+    e.maxBit = 0;
+    e.minGap = 0xffffffffUL;
+    e.edges = 0;
+    e.state = GAP_LEARN_1;
+  }
+
+void learnGap(dscGlobal_t &g, unsigned long intv, bool gap)
+  {
+    // Updates the gap threshold estimators (see dscGap_t), called from the ISR on
+    // every clock edge before the word timing is reset (keep it short)
+    dscGap_t &e = g.gapEst;
+    
+    if (e.state == GAP_TRACK) {
+      if (!gap || g.tBuild.edges == 0) return;
+      // Once per word: running max of the half period and min of the gap, they
+      // follow a rise of the half period/drop of the gap by 1/4 of the difference
+      // per word, and the other way by 1/64
+      unsigned int bit = g.tBuild.maxIntv;
+      if (bit < (e.minGap >> 1)) {              // Not a word with a missed gap in it
+        if (bit > e.maxBit) e.maxBit += (bit - e.maxBit) >> 2;
+        else e.maxBit -= (e.maxBit - bit) >> 6;
+      }
+      // A gap far over the shortest one is the bus stopping (panel busy, power
+      // glitch, keybus unplugged), not a word gap, and would drag minGap up
+      if (intv < e.minGap) e.minGap -= (e.minGap - intv) >> 2;
+      else if (intv <= GAP_STALL_RATIO * e.minGap) e.minGap += (intv - e.minGap) >> 6;
+      e.thresh = (e.maxBit + e.minGap) >> 1;
+      return;
+    }
+    
+    if (e.state == GAP_LEARN_1) {
+      if (intv > e.longest) e.longest = intv;
+    }
+    else if (intv < (e.longest >> 1)) {
+      if (intv > e.maxBit) e.maxBit = intv;
+    }
+    else if (intv < e.minGap) e.minGap = intv;
+    
+    if (++e.edges < GAP_LEARN_EDGES) return;
+    e.edges = 0;
+    if (e.state == GAP_LEARN_1) {
+      e.state = GAP_LEARN_2;
+      return;
+    }
+    
+    // Use the estimates only if the half period and the gap are clearly apart
+    // (a bus that stopped for a while in pass 1 would make everything a "bit")
+    if (e.maxBit >= GAP_MIN_BIT && e.minGap != 0xffffffffUL && e.minGap > 2UL * e.maxBit) {
+      e.thresh = (e.maxBit + e.minGap) >> 1;
+      e.state = GAP_TRACK;
+    }
+    else {
+      resetGap(e);
+      if (e.relearns < 0xff) e.relearns++;
+    }
+  }
+
+int DSC::gapTiming(dscGap_t &g)
+  {
+    // Copies the gap estimators with interrupts off (the ISR updates them)
+    noInterrupts();
+    g = dscGlobal.gapEst;
+    interrupts();
+    return (g.state == GAP_TRACK);
+  }
+
+void clearBus(dscBus_t &b)
+  {
+    memset(&b, 0, sizeof(dscBus_t));
+    b.minGap = 0xffffffffUL;
+    b.minBits = 0xff;
+  }
+
+void addBus(dscBus_t &b, const dscTiming_t &t)
+  {
+    // Called from the ISR with the word that just ended, a few adds per word.
+    // Two gaps in a row (the clock stopped right after a gap) are not a word
+    if (!t.edges) return;
+    b.words++;
+    b.edges += t.edges;
+    b.wordTime += t.sumIntv;
+    b.highTime += t.highTime;
+    b.gapTime += t.gap;
+    if (t.gap < b.minGap) b.minGap = t.gap;
+    if (t.gap > b.maxGap) b.maxGap = t.gap;
+    byte bits = (t.edges >= 510) ? 0xff : (t.edges + 1) / 2;
+    if (bits < b.minBits) b.minBits = bits;
+    if (bits > b.maxBits) b.maxBits = bits;
+  }
+
+void DSC::analyze(bool on)
+  {
+    if (slot >= DSC_INSTANCES) return;
+    noInterrupts();
+    clearBus(dscGlobal.bus);
+    dscGlobal.busOn = on;
+    interrupts();
+    busStart = millis();
+  }
+
+int DSC::busSummary(dscBus_t &s)
+  {
+    unsigned long now = millis();
+    if (slot >= DSC_INSTANCES) return 0;  // return failure, no slot
+    if (!dscGlobal.busOn || (now - busStart) < BUS_WINDOW_MS) return 0;  // return failure
+    
+    // Takes the window and starts the next one, with interrupts off so no word
+    // is added to the copy half way through
+    noInterrupts();
+    s = dscGlobal.bus;
+    clearBus(dscGlobal.bus);
+    unsigned long last = dscGlobal.lastChange;
+    bool high = ((long)(dscGlobal.lastRise - dscGlobal.lastFall) > 0);
+    unsigned long building = dscGlobal.tBuild.sumIntv;  // Time in the word not ended yet
+    byte waiting = dscGlobal.newWord ? 1 : 0;           // Gap seen, process() not called yet
+    interrupts();
+    s.ms = now - busStart;
+    busStart = now;
+    if (!s.words) s.minGap = 0, s.minBits = 0;
+    
+    // No edge for the whole window is a stalled bus, the last edge tells the level
+    // the clock stopped at. A clock running for half the window without a gap is
+    // a threshold problem, and words the ISR saw but process() didn't take were
+    // missed by the main loop. The counts run on from window to window: a word
+    // seen in this window is taken in the next one when its gap came just before
+    // the window closed, so it is carried over instead of counted as missed
+    s.idle = micros() - last;
+    s.flags = 0;
+    if (s.idle / 1000 >= s.ms) {
+      s.flags |= BUS_STALL;
+      if (high) s.flags |= BUS_CLK_HIGH;
+    }
+    else if (building / 1000 >= s.ms / 2) s.flags |= BUS_NO_GAP;
+    long missed = (long)busCarry + s.words - s.taken - waiting;
+    busCarry = waiting;
+    s.missed = (missed > 0) ? missed : 0;
+    if (s.missed) s.flags |= BUS_MISSED;
+    busLast = s;
+    return 1;
+  }
+
+void DSC::printBus(Print &out)
+  {
+    const dscBus_t &s = busLast;
+    out.print(F("Bus "));
+    out.print(s.ms);
+    out.print(F(" ms: "));
+    out.print(s.words);
+    out.print(F(" words ("));
+    out.print(s.taken);
+    out.print(F(" taken), "));
+    out.print(s.minBits);
+    out.print('-');
+    out.print(s.maxBits);
+    out.print(F(" bits, clock high "));
+    out.print(s.wordTime ? (s.highTime * 100.0) / s.wordTime : 0, 0);
+    out.print(F("%, busy "));
+    out.print(s.ms ? (s.wordTime / 10.0) / s.ms : 0, 0);
+    out.print(F("%, gaps "));
+    out.print(s.minGap);
+    out.print('-');
+    out.print(s.maxGap);
+    out.print(F(" us, keypad bits "));
+    out.print(s.edges ? (s.keypadBits * 200.0) / s.edges : 0, 1);
+    out.print('%');
+    if (s.flags & BUS_STALL) {
+      out.print(F(", stalled (clock "));
+      out.print((s.flags & BUS_CLK_HIGH) ? F("high") : F("low"));
+      out.print(F(" for "));
+      out.print(s.idle / 1000);
+      out.print(F(" ms)"));
+    }
+    if (s.flags & BUS_NO_GAP) out.print(F(", no word gaps"));
+    if (s.flags & BUS_MISSED) {
+      out.print(F(", missed "));
+      out.print(s.missed);
+    }
+    out.println();
+  }
+
+int DSC::frameTiming(dscTiming_t &t)
+  {
+    // Copies the last complete word timing, with interrupts off so the ISR
+    // can't change it half way through the copy
+    if (slot >= DSC_INSTANCES) return 0;  // return failure, no slot
+    noInterrupts();
+    t = dscGlobal.tWord;
+    bool isNew = dscGlobal.newTiming;
+    dscGlobal.newTiming = false;
+    interrupts();
+    return isNew;
+  }
+
+int DSC::idle(unsigned long timeout)
+  {
+    // Sleeps (AVR idle mode) until the ISR flags a new word, or until "timeout" ms
+    // have passed. Any interrupt wakes the CPU (the clock line, or the timer behind
+    // millis() about every ms), so the flag and the timeout are re-checked after
+    // every wake. On other boards this waits without sleeping, calling yield()
+    // (the ESP8266 watchdog resets a loop that doesn't yield for a few seconds).
+    if (slot >= DSC_INSTANCES) return 0;  // return failure, no slot (no ISR either)
+    unsigned long start = millis();
+    while (!dscGlobal.newWord) {
+      if ((millis() - start) >= timeout) return 0;  // Return failure (timed out)
+#if defined(__AVR__)
+      set_sleep_mode(SLEEP_MODE_IDLE);
+      noInterrupts();
+      if (!dscGlobal.newWord) {
+        sleep_enable();
+        interrupts();           // The instruction after sei always runs, so an
+        sleep_cpu();            //   interrupt can't slip in before the sleep
+        sleep_disable();
+      }
+      interrupts();
+#else
+      yield();
+#endif
+    }
+    return 1;                   // Return success (a new word is waiting)
+  }
+
 byte DSC::decodePanel(void) 
   {
     // ------------- Process the Panel Data Word ---------------
-    byte cmd = binToInt(dscGlobal.pWord,0,8);   // Get the panel pCmd (data word type/command)
+    // The fields are decoded by the core (DSC_Core.h), only the text is built here
+    dscFrameFromText(dscGlobal.pFrame, dscGlobal.pWord.c_str(), dscGlobal.pWord.length());
+    dscPanelInfo_t info;
+    byte cmd = dscDecodePanel(dscGlobal.pFrame, info);  // Get the panel pCmd (data word type/command)
     
     if (dscGlobal.pWord == dscGlobal.oldPWord || cmd == 0x00) {
       // Skip this word if the data hasn't changed, or pCmd is empty (0x00)
@@ -182,144 +689,108 @@ byte DSC::decodePanel(void)
     }
     else {     
       // This seems to be a valid word, try to process it  
-      dscGlobal.lastData = millis();            // Record the time (last data word was received)
-      dscGlobal.oldPWord = dscGlobal.pWord;     // This is a new/good word, save it
+      markWord(EVT_PANEL, cmd);                 // This is a new/good word, save it
+      String &msg = dscGlobal.pMsg;
      
-      // Interpret the data
+      // Interpret the data, all text comes from the flash string table (DSC_Strings.h)
       if (cmd == 0x05) 
       {
-        dscGlobal.lastStatus = millis();        // Record the time for LED logic
-        dscGlobal.pMsg += F("[Status] ");
-        if (binToInt(dscGlobal.pWord,16,1)) {
-          dscGlobal.pMsg += F("Ready");
-        }
-        else {
-          dscGlobal.pMsg += F("Not Ready");
-        }
-        if (binToInt(dscGlobal.pWord,12,1)) dscGlobal.pMsg += F(", Error");
-        if (binToInt(dscGlobal.pWord,13,1)) dscGlobal.pMsg += F(", Bypass");
-        if (binToInt(dscGlobal.pWord,14,1)) dscGlobal.pMsg += F(", Memory");
-        if (binToInt(dscGlobal.pWord,15,1)) dscGlobal.pMsg += F(", Armed");
-        if (binToInt(dscGlobal.pWord,17,1)) dscGlobal.pMsg += F(", Program");
-        if (binToInt(dscGlobal.pWord,29,1)) dscGlobal.pMsg += F(", Power Fail");   // ??? - maybe 28 or 20?
+        dscGlobal.pStatus = info.status;
+
+        msg += dscStr(STR_STATUS);
+        addStatus(msg, info.status);
       }
      
       if (cmd == 0xa5)
       {
-        dscGlobal.pMsg += F("[Info] ");
-        int y3 = binToInt(dscGlobal.pWord,9,4);
-        int y4 = binToInt(dscGlobal.pWord,13,4);
-        yy = (String(y3) + String(y4)).toInt();
-        mm = binToInt(dscGlobal.pWord,19,4);
-        dd = binToInt(dscGlobal.pWord,23,5);
-        HH = binToInt(dscGlobal.pWord,28,5);
-        MM = binToInt(dscGlobal.pWord,33,6);     
-
-        timeAvailable = true;      // Set the time element status to valid
-
-        byte arm = binToInt(dscGlobal.pWord,41,2);
-        byte master = binToInt(dscGlobal.pWord,43,1);
-        byte user = binToInt(dscGlobal.pWord,43,6); // 0-36
-        if (arm == 0x02) {
-          dscGlobal.pMsg += F(", Armed");
-          user = user - 0x19;
-        }
-        if (arm == 0x03) {
-          dscGlobal.pMsg += F(", Disarmed");
+        msg += dscStr(STR_INFO);
+        if (info.timeValid) {
+          yy = info.year;
+          mm = info.month;
+          dd = info.day;
+          HH = info.hour;
+          MM = info.minute;
+          SS = 0;
+
+          tmElements_t tm;
+          tm.Year = y2kYearToTm(yy);
+          tm.Month = mm;
+          tm.Day = dd;
+          tm.Hour = HH;
+          tm.Minute = MM;
+          tm.Second = 0;
+          time_t t = makeTime(tm);
+          // The panel repeats the 0xa5 word, only a new minute is a clock change
+          if (t != panelTime) {
+            panelTime = t;
+            clockChanged = true;
+          }
+          timeAvailable = true;    // Set the time element status to valid
         }
-        if (arm > 0) {
-          if (master) dscGlobal.pMsg += F(", Master Code"); 
-          else dscGlobal.pMsg += F(", User Code");
-          user += 1; // shift to 1-32, 33, 34
-          if (user > 34) user += 5; // convert to system code 40, 41, 42
-          dscGlobal.pMsg += " " + String(user);
+
+        if (info.arm == 0x02) msg += dscStr(STR_C_ARMED);
+        if (info.arm == 0x03) msg += dscStr(STR_C_DISARMED);
+        if (info.arm > 0) {
+          if (info.master) msg += dscStr(STR_C_MASTER_CODE); 
+          else msg += dscStr(STR_C_USER_CODE);
+          msg += ' ';
+          addNum(msg, info.user);
         }
+        dscGlobal.armState = (info.arm >= 0x02) ? info.arm : 0;
+        dscGlobal.armUser = (info.arm >= 0x02) ? info.user : 0;
       }
       
-      if (cmd == 0x27)
-      {
-        dscGlobal.pMsg += F("[Zones A] ");
-        int zones = binToInt(dscGlobal.pWord,8+1+8+8+8+8,8);
-        if (zones & 1) dscGlobal.pMsg += "1";
-        if (zones & 2) dscGlobal.pMsg += "2";
-        if (zones & 4) dscGlobal.pMsg += "3";
-        if (zones & 8) dscGlobal.pMsg += "4";
-        if (zones & 16) dscGlobal.pMsg += "5";
-        if (zones & 32) dscGlobal.pMsg += "6";
-        if (zones & 64) dscGlobal.pMsg += "7";
-        if (zones & 128) dscGlobal.pMsg += "8";
-        if (zones == 0) dscGlobal.pMsg += "Ready ";
-      }
-      
-      if (cmd == 0x2d)
+      // Zone groups A, B, etc. (only the groups of the panel model, DSC_Config.h)
+      if (info.zoneGroup != ZONE_NONE) 
       {
-        dscGlobal.pMsg += F("[Zones B] ");
-        int zones = binToInt(dscGlobal.pWord,8+1+8+8+8+8,8);
-        if (zones & 1) dscGlobal.pMsg += "9";
-        if (zones & 2) dscGlobal.pMsg += "10";
-        if (zones & 4) dscGlobal.pMsg += "11";
-        if (zones & 8) dscGlobal.pMsg += "12";
-        if (zones & 16) dscGlobal.pMsg += "13";
-        if (zones & 32) dscGlobal.pMsg += "14";
-        if (zones & 64) dscGlobal.pMsg += "15";
-        if (zones & 128) dscGlobal.pMsg += "16";
-        if (zones == 0) dscGlobal.pMsg += "Ready ";
-      }
-      
-      if (cmd == 0x34)
-      {
-        dscGlobal.pMsg += F("[Zones C] ");
-        int zones = binToInt(dscGlobal.pWord,8+1+8+8+8+8,8);
-        if (zones & 1) dscGlobal.pMsg += "17";
-        if (zones & 2) dscGlobal.pMsg += "18";
-        if (zones & 4) dscGlobal.pMsg += "19";
-        if (zones & 8) dscGlobal.pMsg += "20";
-        if (zones & 16) dscGlobal.pMsg += "21";
-        if (zones & 32) dscGlobal.pMsg += "22";
-        if (zones & 64) dscGlobal.pMsg += "23";
-        if (zones & 128) dscGlobal.pMsg += "24";
-        if (zones == 0) dscGlobal.pMsg += "Ready ";
-      }
-      
-      if (cmd == 0x3e)
-      {
-        dscGlobal.pMsg += F("[Zones D] ");
-        int zones = binToInt(dscGlobal.pWord,8+1+8+8+8+8,8);
-        if (zones & 1) dscGlobal.pMsg += "25";
-        if (zones & 2) dscGlobal.pMsg += "26";
-        if (zones & 4) dscGlobal.pMsg += "27";
-        if (zones & 8) dscGlobal.pMsg += "28";
-        if (zones & 16) dscGlobal.pMsg += "29";
-        if (zones & 32) dscGlobal.pMsg += "30";
-        if (zones & 64) dscGlobal.pMsg += "31";
-        if (zones & 128) dscGlobal.pMsg += "32";
-        if (zones == 0) dscGlobal.pMsg += "Ready ";
+        byte grp = info.zoneGroup;
+        msg += dscStr(STR_ZONES);
+        msg += (char)('A' + grp);
+        msg += dscStr(STR_ZONES_END);
+        dscGlobal.zones[grp] = info.zones;
+        for (byte i=0;i<8;i++)
+          if (info.zones & (1 << i)) addNum(msg, (grp * 8) + i + 1);
+        if (info.zones == 0) msg += dscStr(STR_ZONES_READY);
       }
       // --- The other 32 zones for a 1864 panel need to be added after this ---
 
       if (cmd == 0x11) {
-        dscGlobal.pMsg += F("[Keypad Query] ");
+        msg += dscStr(STR_KEYPAD_QUERY);
       }
       if (cmd == 0x0a) {
-        dscGlobal.pMsg += F("[Panel Program Mode] ");
+        // Keypad lights as in the status command, then the programming mode code
+        msg += dscStr(STR_PROGRAM_MODE);
+        addStatus(msg, info.status);
+        msg += dscStr(STR_C_MODE);
+        addHex(msg, info.mode);
       } 
       if (cmd == 0x5d) {
-        dscGlobal.pMsg += F("[Alarm Memory Group 1] ");
+        msg += dscStr(STR_ALARM_MEM_1);
       } 
       if (cmd == 0x63) {
-        dscGlobal.pMsg += F("[Alarm Memory Group 2] ");
+        msg += dscStr(STR_ALARM_MEM_2);
       } 
       if (cmd == 0x64) {
-        dscGlobal.pMsg += F("[Beep Command Group 1] ");
+        msg += dscStr(STR_BEEP_1);
+        addNum(msg, info.beeps);
+        msg += dscStr(STR_C_BEEPS);
       } 
       if (cmd == 0x69) {
-        dscGlobal.pMsg += F("[Beep Command Group 2] ");
+        msg += dscStr(STR_BEEP_2);
+        addNum(msg, info.beeps);
+        msg += dscStr(STR_C_BEEPS);
+        if (info.tone) msg += dscStr(STR_C_CONSTANT_TONE);
+        if (info.interval) {
+          msg += dscStr(STR_C_INTERVAL);
+          addNum(msg, info.interval);
+          msg += dscStr(STR_SECONDS);
+        }
       } 
       if (cmd == 0x39) {
-        dscGlobal.pMsg += F("[Undefined command from panel] ");
+        msg += dscStr(STR_UNDEFINED);
       } 
       if (cmd == 0xb1) {
-        dscGlobal.pMsg += F("[Zone Configuration] ");
+        msg += dscStr(STR_ZONE_CONFIG);
       }
     return cmd;     // Return success
     }
@@ -328,93 +799,94 @@ byte DSC::decodePanel(void)
 byte DSC::decodeKeypad(void) 
   {
     // ------------- Process the Keypad Data Word ---------------
-    byte cmd = binToInt(dscGlobal.kWord,0,8);     // Get the keypad pCmd (data word type/command)
-    String btnStr = F("[Button] ");
+    // Read according to the panel word of the same period (decodePanel() runs first)
+    dscFrameFromText(dscGlobal.kFrame, dscGlobal.kWord.c_str(), dscGlobal.kWord.length());
+    dscKeypadInfo_t info;
+    // The panel command from pWord, pFrame isn't filled when the panel word is filtered
+    byte cmd = dscDecodeKeypad(dscGlobal.kFrame, binToInt(dscGlobal.pWord,0,8), info);
 
-    if (dscGlobal.kWord.indexOf("0") == -1) {  
+    if (info.type == KPD_IDLE) {  
       // Skip this word if kWord is all 1's
       return 0;     // Return failure
     }
+    else if (info.type == KPD_INVALID) {
+      // Reject a garbled button before anything acts on it
+      dscGlobal.kInvalid++;
+      return 0;     // Return failure
+    }
     else { 
       // This seems to be a valid word, try to process it
-      dscGlobal.lastData = millis();              // Record the time (last data word was received)
-      dscGlobal.oldKWord = dscGlobal.kWord;                 // This is a new/good word, save it
-
-      byte kByte2 = binToInt(dscGlobal.kWord,8,8); 
+      markWord(EVT_KEYPAD, cmd);                  // This is a new/good word, save it
+      String &msg = dscGlobal.kMsg;
      
-      // Interpret the data
-      if (cmd == kOut) {
-        if (kByte2 == one)
-          dscGlobal.kMsg += btnStr + "1";
-        else if (kByte2 == two)
-          dscGlobal.kMsg += btnStr + "2";
-        else if (kByte2 == three)
-          dscGlobal.kMsg += btnStr + "3";
-        else if (kByte2 == four)
-          dscGlobal.kMsg += btnStr + "4";
-        else if (kByte2 == five)
-          dscGlobal.kMsg += btnStr + "5";
-        else if (kByte2 == six)
-          dscGlobal.kMsg += btnStr + "6";
-        else if (kByte2 == seven)
-          dscGlobal.kMsg += btnStr + "7";
-        else if (kByte2 == eight)
-          dscGlobal.kMsg += btnStr + "8";
-        else if (kByte2 == nine)
-          dscGlobal.kMsg += btnStr + "9";
-        else if (kByte2 == aster)
-          dscGlobal.kMsg += btnStr + "*";
-        else if (kByte2 == zero)
-          dscGlobal.kMsg += btnStr + "0";
-        else if (kByte2 == pound)
-          dscGlobal.kMsg += btnStr + "#";
-        else if (kByte2 == stay)
-          dscGlobal.kMsg += btnStr + F("Stay");
-        else if (kByte2 == away)
-          dscGlobal.kMsg += btnStr + F("Away");
-        else if (kByte2 == chime)
-          dscGlobal.kMsg += btnStr + F("Chime");
-        else if (kByte2 == reset)
-          dscGlobal.kMsg += btnStr + F("Reset");
-        else if (kByte2 == kExit)
-          dscGlobal.kMsg += btnStr + F("Exit");
-        else if (kByte2 == lArrow)  // These arrow commands don't work every time
-          dscGlobal.kMsg += btnStr + F("<");
-        else if (kByte2 == rArrow)  // They are often reverse for unknown reasons
-          dscGlobal.kMsg += btnStr + F(">");
-        else if (kByte2 == kOut)
-          dscGlobal.kMsg += F("[Keypad Response]");
-        else {
-          dscGlobal.kMsg += "[Keypad] 0x" + String(kByte2, HEX) + " (Unknown)";
-        }
+      // Interpret the data, the button text is in KEY_ index order (DSC_Strings.h)
+      if (info.type == KPD_SLOTS) {
+        dscGlobal.kSlots = info.slots;
+        msg += dscStr(STR_KEYPAD_SLOTS);
+        for (byte i=0;i<KPD_SLOT_COUNT;i++)
+          if (info.slots & (1 << i)) {
+            addNum(msg, i + 1);
+            msg += ' ';
+          }
+      }
+      else if (info.key != KEY_NONE) {
+        msg += dscStr(STR_BUTTON);
+        msg += dscStr(STR_KEY_1 + info.key);
+      }
+      else if (info.type == KPD_RESPONSE)
+        msg += dscStr(STR_KEYPAD_RESPONSE);
+      else if (cmd == kOut) {
+        msg += dscStr(STR_KEYPAD_HEX);
+        addHex(msg, info.data);
+        msg += dscStr(STR_UNKNOWN);
       }
-
-      if (cmd == fire)
-        dscGlobal.kMsg += btnStr + F("Fire");
-      if (cmd == aux)
-        dscGlobal.kMsg += btnStr + F("Auxillary");
-      if (cmd == panic)
-        dscGlobal.kMsg += btnStr + F("Panic");
       
       return cmd;     // Return success
     }
   }
 
+void DSC::addStatus(String &str, byte st)
+  {
+    // Adds the status flags as text, for example "Ready, Bypass, Armed"
+    str += dscStr((st & ST_READY) ? STR_READY : STR_NOT_READY);
+    if (st & ST_ERROR) str += dscStr(STR_C_ERROR);
+    if (st & ST_BYPASS) str += dscStr(STR_C_BYPASS);
+    if (st & ST_MEMORY) str += dscStr(STR_C_MEMORY);
+    if (st & ST_ARMED) str += dscStr(STR_C_ARMED);
+    if (st & ST_PROGRAM) str += dscStr(STR_C_PROGRAM);
+    if (st & ST_POWERFAIL) str += dscStr(STR_C_POWER_FAIL);
+  }
+
+void DSC::addNum(String &str, byte num)
+  {
+    // Adds a number in decimal, one character at a time (no temporary String)
+    if (num >= 100) str += (char)('0' + (num / 100));
+    if (num >= 10) str += (char)('0' + ((num / 10) % 10));
+    str += (char)('0' + (num % 10));
+  }
+
+void DSC::addHex(String &str, byte b)
+  {
+    // Adds a byte as two lower case hex characters
+    str += hex[b >> 4];
+    str += hex[b & 0x0f];
+  }
+
 const char* DSC::pnlFormat(void)
   {
     if (!dscGlobal.pCmd) return NULL;       // return failure
     // Formats the panel binary string into bytes of binary data in the form:
     // 8 1 8 8 8 8 8 etc, and returns a pointer to the buffer 
     pInfo.clear();
-    pInfo.print("[Panel]  ");
+    pInfo.print(dscStr(STR_PANEL_TAG));
 
     if (dscGlobal.pWord.length() > 8) {
       pInfo.print(binToChar(dscGlobal.pWord, 0, 8));
       pInfo.print(" ");
       pInfo.print(binToChar(dscGlobal.pWord, 8, 9));
       pInfo.print(" ");
-      int grps = (dscGlobal.pWord.length() - 9) / 8;
-      for(int i=0;i<grps;i++) {
+      unsigned int grps = (dscGlobal.pWord.length() - 9) / 8;
+      for(unsigned int i=0;i<grps;i++) {
         pInfo.print(binToChar(dscGlobal.pWord, 9+(i*8),9+(i+1)*8));
         pInfo.print(" ");
       }
@@ -424,7 +896,7 @@ const char* DSC::pnlFormat(void)
     else
       pInfo.print(binToChar(dscGlobal.pWord, 0, dscGlobal.pWord.length()));
 
-    if (pnlChkSum(dscGlobal.pWord)) pInfo.print(" (OK)");
+    if (pnlChkSum(dscGlobal.pWord)) pInfo.print(dscStr(STR_CHECKSUM_OK));
 
     return pInfo.getBuffer();               // return the pointer
   }
@@ -434,13 +906,13 @@ const char* DSC::pnlRaw(void)
     if (!dscGlobal.pCmd) return NULL;       // return failure
     // Puts the raw word into a buffer and returns a pointer to the buffer
     pInfo.clear();
-    pInfo.print("[Panel]  ");
+    pInfo.print(dscStr(STR_PANEL_TAG));
     
-    for(int i=0;i<dscGlobal.pWord.length();i++) {
+    for(unsigned int i=0;i<dscGlobal.pWord.length();i++) {
       pInfo.print(dscGlobal.pWord[i]);
     }
     
-    if (pnlChkSum(dscGlobal.pWord)) pInfo.print(" (OK)");
+    if (pnlChkSum(dscGlobal.pWord)) pInfo.print(dscStr(STR_CHECKSUM_OK));
     
     return pInfo.getBuffer();               // return the pointer
   }
@@ -450,9 +922,9 @@ const char* DSC::kpdRaw(void)
     if (!dscGlobal.kCmd) return NULL;       // return failure
     // Puts the raw word into a buffer and returns a pointer to the buffer
     kInfo.clear();
-    kInfo.print("[Keypad] ");
+    kInfo.print(dscStr(STR_KEYPAD_TAG));
     
-    for(int i=0;i<dscGlobal.kWord.length();i++) {
+    for(unsigned int i=0;i<dscGlobal.kWord.length();i++) {
       kInfo.print(dscGlobal.kWord[i]);
     }
     
@@ -465,11 +937,11 @@ const char* DSC::kpdFormat(void)
     // Formats the referenced string into bytes of binary data in the form:
     // 8 8 8 8 8 8 etc, and returns a pointer to the buffer 
     kInfo.clear();
-    kInfo.print("[Keypad] ");
+    kInfo.print(dscStr(STR_KEYPAD_TAG));
     
     if (dscGlobal.kWord.length() > 8) {
-      int grps = dscGlobal.kWord.length() / 8;
-      for(int i=0;i<grps;i++) {
+      unsigned int grps = dscGlobal.kWord.length() / 8;
+      for(unsigned int i=0;i<grps;i++) {
         kInfo.print(binToChar(dscGlobal.kWord, i*8,(i+1)*8));
         kInfo.print(" ");
       }
@@ -485,38 +957,23 @@ const char* DSC::kpdFormat(void)
 int DSC::pnlChkSum(String &dataStr)
   {
     // Sums all but the last full byte (minus padding) and compares to last byte
-    // returns 0 if not valid, and 1 if checksum valid
-    int cSum = 0;
-    if (dataStr.length() > 8) {
-      cSum += binToInt(dataStr,0,8);
-      int grps = (dataStr.length() - 9) / 8;
-      for(int i=0;i<grps;i++) {
-        if (i<(grps-1)) 
-          cSum += binToInt(dataStr,9+(i*8),8);
-        else {
-          byte cSumMod = cSum % 256;
-          //String cSumStr = String(chkSum, HEX);
-          //int cSumLen = cSumStr.length();
-          byte lastByte = binToInt(dataStr,9+(i*8),8);
-          //byte cSumByte = binToInt(cSumStr,(cSumLen-2),2);
-          //if (cSumSub == lastByte) return true;
-          //Serial.println(cSum);
-          //Serial.println(cSumMod);
-          //Serial.println(lastByte);
-          if (cSumMod == lastByte) return 1;
-        }
-      }
-    }
-    return 0;
+    // returns 0 if not valid, and 1 if checksum valid (see dscPanelChecksum())
+    dscFrame_t f;
+    dscFrameFromText(f, dataStr.c_str(), dataStr.length());
+    return dscPanelChecksum(f);
   }
 
 unsigned int DSC::binToInt(String &dataStr, int offset, int dataLen)
   {
     // Returns the value of the binary data in the String from "offset" to "dataLen" as an int
-    int iBuf = 0;
+    // Characters past the end of the String read as 0, at most 16 are read
+    if (offset < 0 || dataLen < 0) return 0;  // return failure
+    if (dataLen > 16) dataLen = 16;
+    unsigned int iBuf = 0;
+    unsigned int len = dataStr.length();
     for(int j=0;j<dataLen;j++) {
       iBuf <<= 1;
-      if (dataStr[offset+j] == '1') iBuf |= 1;
+      if ((unsigned int)(offset+j) < len && dataStr[offset+j] == '1') iBuf |= 1;
     }
     return iBuf;
   }
@@ -525,9 +982,11 @@ const char* DSC::binToChar(String &dataStr, int offset, int endData)
   {   
     tempByte.clear();
     // Returns a char array of the binary data in the String from "offset" to "endData"
-    tempByte.print(dataStr[offset]);
-    for(int j=1;j<(endData-offset);j++) {
-      tempByte.print(dataStr[offset+j]);
+    // (cut at the end of the String, and at the tempByte capacity)
+    if (offset < 0) return tempByte.getBuffer();    // return failure (empty)
+    if (endData > (int)dataStr.length()) endData = dataStr.length();
+    for(int j=offset;j<endData;j++) {
+      tempByte.print(dataStr[j]);
     }
     return tempByte.getBuffer();
   }
@@ -570,22 +1029,25 @@ void DSC::setLED(int p)
     LED = p;
   }
 
-size_t DSC::write(uint8_t character) 
+size_t DSC::write(uint8_t /*character*/) 
   { 
     // Code to display letter when given the ASCII code for it
+    return 0;                     // Nothing is written (not implemented)
   }
 
-size_t DSC::write(const char *str) 
+size_t DSC::write(const char * /*str*/) 
   { 
     // Code to display string when given a pointer to the beginning -- 
     // remember, the last character will be null, so you can use a while(*str). 
     // You can increment str (str++) to get the next letter
+    return 0;                     // Nothing is written (not implemented)
   }
   
-size_t DSC::write(const uint8_t *buffer, size_t size) 
+size_t DSC::write(const uint8_t * /*buffer*/, size_t /*size*/) 
   { 
     // Code to display array of chars when given a pointer to the beginning 
     // of the array and a size -- this will not end with the null character
+    return 0;                     // Nothing is written (not implemented)
   }
 
 ///////// OLD //////////
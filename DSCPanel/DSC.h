@@ -21,6 +21,10 @@ DSC.h (
 #define DSC_h
 #include "DSC_Globals.h"
 #include "DSC_Constants.h"
+#include "DSC_Events.h"
+#include "DSC_Recorder.h"
+#include <TextBuffer.h>
+#include <TimeLib.h>
 
 #if defined(ARDUINO) && ARDUINO >= 100
 #include "Arduino.h"
@@ -33,6 +37,9 @@ class DSC : public Print  // Initialize DSC as an extension of the print class
   public:
     // Class to call to initialize the DSC Class
     // for example...  DSC dsc;
+    // Up to DSC_INSTANCES objects can be created (DSC_Config.h), each on its own
+    // clock pin, for example a Mega watching two panels:  DSC dsc1, dsc2;
+    // An object past DSC_INSTANCES is unusable: begin() fails and process() returns 0
     DSC(void);
     
     // Used to add the serial instance to the DSC Class
@@ -40,15 +47,70 @@ class DSC : public Print  // Initialize DSC as an extension of the print class
     
     // Included in the setup function of the user's sketch
     // Begins the the class, sets the pin modes, attaches the interrupt
-    void begin(void);
+    // Returns:   1 for success, 0 if there are more DSC objects than DSC_INSTANCES
+    //            or the clock pin has no interrupt
+    int begin(void);
     
     // Included in the main loop of user's sketch, checks and processes 
     // the current panel and keypad words if able
     // Returns:   0   (No 
     int process(void);
     
-    // Decodes the panel and keypad words, returns 0 for failure and the command
-    // byte for success
+    // Optionally called in the main loop before process(), sleeps the MCU (AVR 
+    // idle mode) until the ISR signals a new word or "timeout" ms have passed
+    // Returns:   1 if a new word is waiting, 0 on timeout
+    int idle(unsigned long timeout);
+    
+    // Registers the function called from process() for alarm-critical events
+    // (fire/aux/panic keys, alarm memory, arm/disarm), before any formatting
+    void onCritical(void (*fn)(const dscEvent_t &evt));
+    
+    // Sets the queue that receives the decoded words as events, critical ones
+    // only go to the queue if no onCritical() function is registered
+    void setQueue(DSCEventQueue &q);
+    
+    // Sets the recorder the ISR hands every clock edge to (NULL to detach)
+    void setRecorder(DSCRecorder *r);
+    
+    // Sets the command filter of the panel (EVT_PANEL) or keypad (EVT_KEYPAD)
+    // words. The lists are compiled into a 256 bit mask: with an allow list only
+    // those commands pass, and the deny list is taken out of what passes (NULL/0
+    // for no list). process() drops a filtered word right after reading its
+    // command byte, before decoding, formatting and the event queue. The
+    // alarm-critical events (onCritical()) are never filtered
+    void setFilter(byte src, const byte *allow, byte allowCount, 
+                   const byte *deny, byte denyCount);
+    
+    // Removes the filter of "src" (every command passes)
+    void clearFilter(byte src);
+    
+    // Returns 1 if words with command "cmd" from "src" pass the filter, 0 if not
+    int allowed(byte src, byte cmd);
+    
+    // Copies the clock timing of the last complete word into "t"
+    // Returns:   1 if it is new since the last call, 0 if not
+    int frameTiming(dscTiming_t &t);
+    
+    // Turns the bus analyzer on or off. While it is on, the ISR adds the timing of
+    // each word (bits, clock high time, gap) to a window of BUS_WINDOW_MS
+    void analyze(bool on);
+    
+    // Closes the analyzer window once BUS_WINDOW_MS have passed and copies it into
+    // "s", with the BUS_ flags set. Call it every loop, or from a 1 s task
+    // Returns:   1 if a new window was copied, 0 if not (or the analyzer is off)
+    int busSummary(dscBus_t &s);
+    
+    // Prints the last window closed by busSummary(): words seen and taken, bits
+    // per word, clock duty, bus busy time, gaps, keypad bits and the flags
+    void printBus(Print &out);
+    
+    // Copies the new word gap threshold and the estimators it is learned from
+    // (clock half period and gap, see dscGap_t) into "g"
+    // Returns:   1 once the threshold is learned, 0 while learning
+    int gapTiming(dscGap_t &g);
+    
+    // Decodes the panel and keypad words (fields by the decoder core, DSC_Core.h,
+    // text here), returns 0 for failure and the command byte for success
     byte decodePanel(void);
     byte decodeKeypad(void);
     
@@ -81,12 +143,90 @@ class DSC : public Print  // Initialize DSC as an extension of the print class
     virtual size_t write(const char *str);
     virtual size_t write(const uint8_t *buffer, size_t size);
 
-    // Class level variables to hold time elements
+    // Class level variables to hold time elements, yy is 0-99 (20yy), SS is always 0
+    // (the panel sends the time to the minute)
     int yy, mm, dd, HH, MM, SS;
-    bool timeAvailable;
+    bool timeAvailable;             // This word is a 0xa5 with a valid date/time
+    time_t panelTime;               // Last valid panel time (TimeLib), 0 if none yet
+    bool clockChanged;              // This word moved panelTime to a new minute, only
+                                    // then does the system time need setting:
+                                    //   if (dsc.clockChanged) setTime(dsc.panelTime);
+    
+    // This object's capture and decode state. Inside the class it hides the global
+    // dscGlobal, which is the first object's state (used by the example sketches)
+    dscGlobal_t &dscGlobal;
 
   private:
+    // Interrupt handler for this object, called on clock line change through the
+    // static trampoline of its slot (attachInterrupt() can't call a member)
+    void clkCalled(void);
+    static void clkCalled0(void);
+    static void clkCalled1(void);
+    static void clkCalled2(void);
+    static void clkCalled3(void);
+    static void (* const clkHandlers[4])(void);
+    static DSC *instances[DSC_INSTANCES];
+    static byte instanceCount;
+    
+    // Message building helpers for the decoders, the text is added straight
+    // from the flash string table (DSC_Strings.h)
+    void addStatus(String &str, byte st);
+    void addNum(String &str, byte num);
+    void addHex(String &str, byte b);
+    
+    // Counts the word/message Strings whose buffer moved since the last call
+    // (reallocated) in dscGlobal.strAllocs
+    void countAllocs(void);
+    const char *strBuf[STRING_FIELDS];  // Buffers of the Strings at the last count
+    
+    // Hands the alarm-critical events of the new words to the callback/queue,
+    // returns EVT_PANEL and/or EVT_KEYPAD for the words that were critical
+    byte dispatchCritical(void);
+    void raise(byte src, byte cmd, byte data, bool critical);
+    
+    // Last critical event per source (cmd << 8 | data) and when it was last seen,
+    // the panel repeats it between other words (see EVT_REPEAT_MS)
+    // Returns:   1 if the event is new, 0 if it is a repeat
+    int newCritical(byte src, byte cmd, byte data);
+    unsigned int critKey[2];
+    unsigned long critSeen[2];
+    
+    void (*criticalFn)(const dscEvent_t &evt);
+    DSCEventQueue *queue;
+    DSCRecorder * volatile recorder;
+    
+    // Records a new word as seen: the duplicate check (oldPWord/oldKWord), the no
+    // data timer and the status LED. Decoded and filtered words both call it, so
+    // a filtered command still counts as traffic and as the last word
+    void markWord(byte src, byte cmd);
+    
+    // Command filter masks, one bit per command byte (1 passes)
+    byte pFilter[32];
+    byte kFilter[32];
+    
+    // Bus analyzer: start of the open window and the last window closed
+    unsigned long busStart;
+    dscBus_t busLast;
+    byte busCarry;      // A word waiting for process() when the last window closed
+    
+    // Sets this object's capture and decode state to the start values (only
+    // for an object with a slot, the others must not touch the shared state)
+    void initState(void);
+    
+    byte slot;          // Index in instances[] and dscState[], DSC_INSTANCES if none
     uint8_t intrNum;
+    byte ledState;      // Last value written to the LED pin
+    
+    // ----- Input/Output Pins -----
+    byte CLK;           // Keybus Yellow (Clock Line)
+    byte DTA_IN;        // Keybus Green (Data Line via V divider)
+    byte DTA_OUT;       // Keybus Green Output (Data Line through driver)
+    byte LED;           // LED pin on the arduino
+    
+    // ----- Format Buffers -----
+    TextBuffer tempByte;  // Temp byte buffer
+    TextBuffer pInfo;     // Panel info
+    TextBuffer kInfo;     // Keypad info
 };
 
 #endif
@@ -0,0 +1,121 @@
+#include "Arduino.h"
+#include "DSC_Anomaly.h"
+
+DSCAnomaly::DSCAnomaly(void)
+  {
+    reset();
+  }
+
+void DSCAnomaly::reset(void)
+  {
+    learnCount = 0;
+    avgIntv = 0;
+    avgJitter = 0;
+    avgGap = 0;
+    minEdges = 0xffff;
+    maxEdges = 0;
+    binMask = 0;
+    lastUpdate = millis();
+    for (byte i=0;i<ANOM_FLAGS;i++) count[i] = 0;
+  }
+
+byte DSCAnomaly::update(const dscTiming_t &t)
+  {
+    lastUpdate = millis();
+    if (t.edges == 0) return 0;                   // Nothing to compare (empty word)
+
+    unsigned int intv = t.sumIntv / t.edges;      // Average half period of this word
+    unsigned int jitter = t.maxIntv - t.minIntv;
+    unsigned int bins = 0;
+    for (byte i=0;i<TIMING_BINS;i++)
+      if (t.hist[i]) bins |= (1U << i);
+
+    // ----- Learning the baseline -----
+    if (learnCount < ANOM_LEARN_WORDS) {
+      if (learnCount == 0) {
+        avgIntv = intv;
+        avgJitter = jitter;
+        avgGap = t.gap;
+      }
+      else {
+        // Running averages (1/8 weight for the new value)
+        avgIntv = avgIntv - (avgIntv >> 3) + (intv >> 3);
+        avgJitter = avgJitter - (avgJitter >> 3) + (jitter >> 3);
+        avgGap = avgGap - (avgGap >> 3) + (t.gap >> 3);
+      }
+      if (t.edges < minEdges) minEdges = t.edges;
+      if (t.edges > maxEdges) maxEdges = t.edges;
+      binMask |= bins;
+      learnCount++;
+      return 0;
+    }
+
+    // ----- Comparing to the baseline -----
+    byte flags = 0;
+
+    // Clock high (or low) for almost the whole word, something holds the line
+    unsigned long total = t.sumIntv;
+    if (t.highTime < (total >> 3) || t.highTime > (total - (total >> 3)))
+      flags |= ANOM_SHORT;
+
+    // Edges in histogram bins that were never seen while learning
+    unsigned int foreign = 0;
+    unsigned int extra = bins & ~binMask;
+    for (byte i=0;i<TIMING_BINS;i++)
+      if (extra & (1U << i)) foreign += t.hist[i];
+    if (foreign >= ANOM_FOREIGN_EDGES) flags |= ANOM_FOREIGN;
+
+    // Average half period off by more than 25%, the clock is running at another
+    // rate (a device clocking the bus itself, or a different panel)
+    if (intv > avgIntv + (avgIntv >> 2) || intv < avgIntv - (avgIntv >> 2))
+      flags |= ANOM_RATE;
+
+    // Jitter more than double the baseline (with a 64 us floor, one histogram bin)
+    if (jitter > (avgJitter << 1) + (1 << TIMING_BIN_SHIFT)) flags |= ANOM_JITTER;
+
+    // Gap off by more than 25%
+    if (t.gap > avgGap + (avgGap >> 2) || t.gap < avgGap - (avgGap >> 2))
+      flags |= ANOM_GAP;
+
+    // Word length outside the learned range, with 25% slack
+    if (t.edges > maxEdges + (maxEdges >> 2) || t.edges < minEdges - (minEdges >> 2))
+      flags |= ANOM_LENGTH;
+
+    // A gap over 4 times the average is a clock stall, not a new kind of word
+    if (t.gap > (avgGap << 2)) flags |= ANOM_STALL;
+
+    // Keep following slow drift (temperature, wiring) while the bus looks normal
+    if (!flags) {
+      avgIntv = avgIntv - (avgIntv >> 3) + (intv >> 3);
+      avgJitter = avgJitter - (avgJitter >> 3) + (jitter >> 3);
+      avgGap = avgGap - (avgGap >> 3) + (t.gap >> 3);
+    }
+
+    for (byte i=0;i<ANOM_FLAGS;i++)
+      if ((flags & (1U << i)) && count[i] < 0xffff) count[i]++;
+    return flags;
+  }
+
+byte DSCAnomaly::stalled(void)
+  {
+    if ((millis() - lastUpdate) > ANOM_STALL_MS) return ANOM_STALL;
+    return 0;
+  }
+
+int DSCAnomaly::learned(void)
+  {
+    return (learnCount >= ANOM_LEARN_WORDS);
+  }
+
+void DSCAnomaly::printFlags(Print &out, byte flags)
+  {
+    bool first = true;
+    if (flags & ANOM_STALL)   { out.print(F("Stall")); first = false; }
+    if (flags & ANOM_SHORT)   { if (!first) out.print(", "); out.print(F("Short")); first = false; }
+    if (flags & ANOM_FOREIGN) { if (!first) out.print(", "); out.print(F("Foreign")); first = false; }
+    if (flags & ANOM_JITTER)  { if (!first) out.print(", "); out.print(F("Jitter")); first = false; }
+    if (flags & ANOM_GAP)     { if (!first) out.print(", "); out.print(F("Gap")); first = false; }
+    if (flags & ANOM_LENGTH)  { if (!first) out.print(", "); out.print(F("Length")); first = false; }
+    if (flags & ANOM_RATE)    { if (!first) out.print(", "); out.print(F("Rate")); first = false; }
+    if (first) out.print(F("None"));
+  }
@@ -0,0 +1,82 @@
+/* DSC_Anomaly.h
+ * Part of DSC Library 
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Keybus timing anomaly (tamper) detector. It learns a baseline from the clock
+ * timing of the first words (see DSC::frameTiming()) and then flags words that
+ * deviate from it: bus shorts, a foreign device driving the clock (or clocking
+ * at another rate), clock stalls.
+ *
+ * Memory use is fixed and each update does a constant amount of work, so it can
+ * be fed every word without slowing the decoding down.
+ *
+ * Usage in the main loop:
+ *    dscTiming_t t;
+ *    if (dsc.frameTiming(t)) flags = anomaly.update(t);
+ *    flags |= anomaly.stalled();
+ */
+
+#ifndef DSC_Anomaly_h
+#define DSC_Anomaly_h
+#include "DSC_Globals.h"
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+// ----- Anomaly Flags (returned by update() and stalled()) -----
+const byte ANOM_STALL   = 0x01;   // No words, or the clock stopped for too long
+const byte ANOM_SHORT   = 0x02;   // Clock stuck high/low for most of the word (bus short)
+const byte ANOM_FOREIGN = 0x04;   // Half periods outside the learned histogram (injection)
+const byte ANOM_JITTER  = 0x08;   // Clock jitter well above the learned baseline
+const byte ANOM_GAP     = 0x10;   // New word gap length differs from the baseline
+const byte ANOM_LENGTH  = 0x20;   // Edge count (word length) outside the learned range
+const byte ANOM_RATE    = 0x40;   // Average half period (clock rate) off the baseline
+const byte ANOM_FLAGS   = 7;      // Number of flags above (size of count[])
+
+// ----- Detector Defaults -----
+const byte ANOM_LEARN_WORDS = 32;       // Words used to learn the baseline
+const unsigned int ANOM_STALL_MS = 2000; // No word for this long is a stall
+const byte ANOM_FOREIGN_EDGES = 4;      // Edges outside the baseline bins to flag
+
+class DSCAnomaly
+{
+  public:
+    // Class to call to initialize the detector
+    // for example...  DSCAnomaly anomaly;
+    DSCAnomaly(void);
+    
+    // Forgets the baseline and starts learning again
+    void reset(void);
+    
+    // Feeds the timing of one complete word, returns the anomaly flags (0 if none)
+    // No flags are returned while the baseline is being learned
+    byte update(const dscTiming_t &t);
+    
+    // Returns ANOM_STALL if no word was fed in the last ANOM_STALL_MS ms, 0 if not
+    byte stalled(void);
+    
+    // Returns 1 once the baseline has been learned, 0 while still learning
+    int learned(void);
+    
+    // Prints the flags as text (for example "Short, Foreign") to "out"
+    void printFlags(Print &out, byte flags);
+    
+    // Counters of the words flagged since begin/reset (per flag, saturating),
+    // count[i] is for the flag (1 << i)
+    unsigned int count[ANOM_FLAGS];
+    
+  private:
+    byte learnCount;                // Words seen while learning
+    unsigned int avgIntv;           // Baseline average half period (us)
+    unsigned int avgJitter;         // Baseline half period jitter, max-min (us)
+    unsigned long avgGap;           // Baseline new word gap (us)
+    unsigned int minEdges;          // Baseline range of edges per word
+    unsigned int maxEdges;
+    unsigned int binMask;           // Histogram bins seen while learning
+    unsigned long lastUpdate;       // millis() of the last update
+};
+
+#endif
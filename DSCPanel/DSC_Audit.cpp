@@ -0,0 +1,187 @@
+#include "Arduino.h"
+#include "DSC_Audit.h"
+
+DSCAudit::DSCAudit(void)
+  {
+    clear();
+  }
+
+void DSCAudit::clear(void)
+  {
+    memset(users, 0, sizeof(users));
+    for (byte i=0;i<AUDIT_CODES;i++) users[i].recent = AUDIT_NONE;
+    memset(ring, 0, sizeof(ring));
+    head = 0;
+    last[0] = last[1] = 0;
+    lastAt[0] = lastAt[1] = 0;
+    lastMs = 0;
+    events = 0;
+  }
+
+byte DSCAudit::codeIndex(byte code)
+  {
+    // 1-34 to 0-33, 40-42 to 34-36
+    if (code >= 1 && code <= 34) return code - 1;
+    if (code >= 40 && code <= 42) return code - 40 + 34;
+    return AUDIT_NONE;
+  }
+
+byte DSCAudit::update(DSC &dsc)
+  {
+    if (dsc.dscGlobal.pCmd != 0xa5) return 0;
+    byte type = dsc.dscGlobal.armState;
+    byte code = dsc.dscGlobal.armUser;
+    if (type != AUDIT_ARM && type != AUDIT_DISARM) return 0;
+
+    // The panel sends the event again in the next 0xa5 words
+    const dscAuditEvent_t *e = recent(0);
+    if (e && e->type == type && e->user == code && (millis() - lastMs) < AUDIT_REPEAT_MS)
+      return 0;
+
+    // The word's time, 0 (not known) if its date/time fields were out of range
+    if (!record(code, type, dsc.timeAvailable ? dsc.panelTime : 0)) return 0;
+    lastMs = millis();
+    return type;
+  }
+
+int DSCAudit::record(byte user, byte type, time_t t)
+  {
+    byte idx = codeIndex(user);
+    if (idx == AUDIT_NONE) return 0;            // return failure (no such code)
+    if (type != AUDIT_ARM && type != AUDIT_DISARM) return 0;
+
+    dscUser_t &u = users[idx];
+    if (type == AUDIT_ARM) {
+      u.lastArm = t;
+      if (u.arms < 0xffff) u.arms++;
+    }
+    else {
+      u.lastDisarm = t;
+      if (u.disarms < 0xffff) u.disarms++;
+    }
+    last[type - AUDIT_ARM] = user;
+    lastAt[type - AUDIT_ARM] = t;
+
+    // Overwrites the oldest entry, the code's chain is checked by event number
+    dscAuditEvent_t &e = ring[head];
+    e.time = t;
+    e.seq = ++events;
+    e.user = user;
+    e.type = type;
+    e.prev = u.recent;
+    u.recent = head;
+    head = (head + 1) % AUDIT_RING;
+    return 1;
+  }
+
+const dscUser_t *DSCAudit::user(byte code)
+  {
+    byte idx = codeIndex(code);
+    if (idx == AUDIT_NONE) return NULL;
+    return &users[idx];
+  }
+
+byte DSCAudit::lastUser(byte type)
+  {
+    if (type != AUDIT_ARM && type != AUDIT_DISARM) return 0;
+    return last[type - AUDIT_ARM];
+  }
+
+time_t DSCAudit::lastTime(byte type)
+  {
+    if (type != AUDIT_ARM && type != AUDIT_DISARM) return 0;
+    return lastAt[type - AUDIT_ARM];
+  }
+
+const dscAuditEvent_t *DSCAudit::latest(byte code)
+  {
+    const dscUser_t *u = user(code);
+    if (!u || u->recent == AUDIT_NONE) return NULL;
+    const dscAuditEvent_t *e = &ring[u->recent];
+    // The entry may have been overwritten by a newer event of another code
+    if (e->user != code || e->seq + AUDIT_RING <= events) return NULL;
+    return e;
+  }
+
+const dscAuditEvent_t *DSCAudit::previous(const dscAuditEvent_t *e)
+  {
+    if (!e || e->prev == AUDIT_NONE) return NULL;
+    const dscAuditEvent_t *p = &ring[e->prev];
+    // Still the same code's older event, not an entry reused since
+    if (p->user != e->user || p->seq >= e->seq || p->seq + AUDIT_RING <= events) return NULL;
+    return p;
+  }
+
+const dscAuditEvent_t *DSCAudit::recent(byte n)
+  {
+    if (n >= AUDIT_RING || n >= events) return NULL;
+    return &ring[(head + AUDIT_RING - 1 - n) % AUDIT_RING];
+  }
+
+void DSCAudit::printTime(Print &out, time_t t)
+  {
+    // yyyy-mm-dd hh:mm, or "-" if not known
+    if (!t) {
+      out.print('-');
+      return;
+    }
+    out.print(year(t));
+    out.print('-');
+    if (month(t) < 10) out.print('0');
+    out.print(month(t));
+    out.print('-');
+    if (day(t) < 10) out.print('0');
+    out.print(day(t));
+    out.print(' ');
+    if (hour(t) < 10) out.print('0');
+    out.print(hour(t));
+    out.print(':');
+    if (minute(t) < 10) out.print('0');
+    out.print(minute(t));
+  }
+
+void DSCAudit::printEvent(Print &out, const dscAuditEvent_t &e)
+  {
+    out.print((e.type == AUDIT_ARM) ? F("Armed by ") : F("Disarmed by "));
+    out.print(e.user);
+    out.print(F(", "));
+    printTime(out, e.time);
+  }
+
+void DSCAudit::print(Print &out)
+  {
+    out.print(F("Last arm: "));
+    out.print(last[0]);
+    out.print(F(", "));
+    printTime(out, lastAt[0]);
+    out.println();
+    out.print(F("Last disarm: "));
+    out.print(last[1]);
+    out.print(F(", "));
+    printTime(out, lastAt[1]);
+    out.println();
+
+    out.println(F("Code  Arms  Last arm  Disarms  Last disarm"));
+    for (byte i=0;i<AUDIT_CODES;i++) {
+      const dscUser_t &u = users[i];
+      if (!u.arms && !u.disarms) continue;
+      out.print((i < 34) ? i + 1 : i - 34 + 40);
+      out.print(F("  "));
+      out.print(u.arms);
+      out.print(F("  "));
+      printTime(out, u.lastArm);
+      out.print(F("  "));
+      out.print(u.disarms);
+      out.print(F("  "));
+      printTime(out, u.lastDisarm);
+      out.println();
+    }
+
+    out.println(F("Recent:"));
+    for (byte n=0;n<AUDIT_RING;n++) {
+      const dscAuditEvent_t *e = recent(n);
+      if (!e) break;
+      printEvent(out, *e);
+      out.println();
+    }
+  }
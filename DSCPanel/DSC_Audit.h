@@ -0,0 +1,121 @@
+/* DSC_Audit.h
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Arm/disarm audit index. The arm/disarm words (0xa5) carry the code that was
+ * used and the panel time, this keeps them by user code: the last arm and last
+ * disarm time and the counts per user, the last user to arm and to disarm, and
+ * a ring of the recent events. Every query is O(1), no log is scanned:
+ *    audit.lastUser(AUDIT_DISARM), audit.lastTime(AUDIT_DISARM)
+ *    audit.user(40)->lastDisarm
+ * and each ring entry links to the same user's previous event, so the recent
+ * events of one user are walked without looking at the others.
+ *
+ * The times are the panel time of the 0xa5 word (TimeLib time_t, to the minute).
+ * Memory: 13 bytes per code (AUDIT_CODES) plus 11 per ring entry, about 660
+ * bytes, so it fits a Mega better than an Uno.
+ *
+ * Usage:
+ *    DSCAudit audit;
+ *    if (dsc.process()) audit.update(dsc);     (every loop)
+ *    audit.print(client);                      (for example on /AUDIT)
+ */
+
+#ifndef DSC_Audit_h
+#define DSC_Audit_h
+#include "DSC.h"
+#include <TimeLib.h>
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+// Codes: users 1-32, 33 and 34, then the system codes 40-42 (see DSC_Core.h)
+const byte AUDIT_CODES = 37;
+const byte AUDIT_RING = 16;             // Recent events kept
+const byte AUDIT_NONE = 0xff;           // No ring entry
+
+// ----- Event Types (the arm field of the 0xa5 word) -----
+const byte AUDIT_ARM    = 0x02;
+const byte AUDIT_DISARM = 0x03;
+
+// The same code arming (or disarming) again within this time is the panel
+// repeating the event, not a new one
+const unsigned long AUDIT_REPEAT_MS = 60000;
+
+typedef struct
+{
+  time_t lastArm;                 // Panel time of the last arm, 0 if never
+  time_t lastDisarm;              // Panel time of the last disarm, 0 if never
+  unsigned int arms;              // Counts (saturating)
+  unsigned int disarms;
+  byte recent;                    // Ring index of the code's last event, AUDIT_NONE
+}
+dscUser_t;
+
+typedef struct
+{
+  time_t time;                    // Panel time
+  unsigned long seq;              // Event number, 1 for the first
+  byte user;                      // Code number (1-34, 40-42)
+  byte type;                      // AUDIT_ARM or AUDIT_DISARM
+  byte prev;                      // Ring index of the same code's previous event
+}
+dscAuditEvent_t;
+
+class DSCAudit
+{
+  public:
+    // Class to call to initialize the audit index
+    // for example...  DSCAudit audit;
+    DSCAudit(void);
+
+    // Forgets all the events and counts
+    void clear(void);
+
+    // Called after DSC.process(), records the arm/disarm of a new 0xa5 word
+    // Returns:   AUDIT_ARM or AUDIT_DISARM for a new event, 0 if none
+    byte update(DSC &dsc);
+
+    // Records an event directly (from another source, or restoring a saved log)
+    // Returns:   1 for success, 0 for a bad code or type
+    int record(byte user, byte type, time_t t);
+
+    // Returns the record of a code (1-34, 40-42), NULL if there is no such code
+    const dscUser_t *user(byte code);
+
+    // Returns the code of the last arm or disarm (AUDIT_ARM/AUDIT_DISARM), 0 if none
+    byte lastUser(byte type);
+
+    // Returns the panel time of the last arm or disarm, 0 if none
+    time_t lastTime(byte type);
+
+    // Returns the newest event of a code, or the one before "e" of the same code
+    // NULL if there is none left in the ring
+    const dscAuditEvent_t *latest(byte code);
+    const dscAuditEvent_t *previous(const dscAuditEvent_t *e);
+
+    // Returns the "n"th most recent event of any code (0 newest), NULL if none
+    const dscAuditEvent_t *recent(byte n);
+
+    // Prints the last arm/disarm, one line per code seen and the recent events
+    void print(Print &out);
+
+    unsigned long events;           // Events recorded
+
+  private:
+    static byte codeIndex(byte code);
+    void printTime(Print &out, time_t t);
+    void printEvent(Print &out, const dscAuditEvent_t &e);
+
+    dscUser_t users[AUDIT_CODES];
+    dscAuditEvent_t ring[AUDIT_RING];
+    byte head;                      // Ring index of the next event
+    byte last[2];                   // Code of the last arm [0] and disarm [1]
+    time_t lastAt[2];
+    unsigned long lastMs;           // millis() of the last event (repeat check)
+};
+
+#endif
@@ -0,0 +1,71 @@
+/* DSC_Config.h
+ * Part of DSC Library 
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Compile time panel model profile. DSC_PANEL selects the number of zones, 
+ * which zone group decoders are compiled in and the word buffer sizes, so a 
+ * smaller panel doesn't carry code and strings for zones it can't have.
+ *
+ * Change the default below, or set it as a build flag (-DDSC_PANEL=1816). The
+ * Arduino IDE compiles the library apart from the sketch, so a #define in the 
+ * sketch itself is not seen here.
+ */
+
+#ifndef DSC_Config_h
+#define DSC_Config_h
+
+#ifndef DSC_PANEL
+#define DSC_PANEL 1864        // PowerSeries panel model: 1816, 1832 or 1864
+#endif
+
+#if DSC_PANEL == 1816
+  #define DSC_ZONES      16
+  #define DSC_MAX_BITS   96   // The longest word decoded on a 1816 (0x27/0xa5) is 49 bits
+  #define DSC_WORD_BITS  96
+#elif DSC_PANEL == 1832
+  #define DSC_ZONES      32
+  #define DSC_MAX_BITS   128
+  #define DSC_WORD_BITS  108
+#elif DSC_PANEL == 1864
+  #define DSC_ZONES      64
+  #define DSC_MAX_BITS   128
+  #define DSC_WORD_BITS  108
+#else
+  #error "DSC_PANEL must be 1816, 1832 or 1864"
+#endif
+
+// Number of DSC objects (Keybus connections) that can run at the same time. Each 
+// one needs its own interrupt capable clock pin and about 150 bytes of RAM, so 
+// only the Mega defaults to more than one (up to 4 are supported)
+#ifndef DSC_INSTANCES
+  #if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+    #define DSC_INSTANCES 2
+  #else
+    #define DSC_INSTANCES 1
+  #endif
+#endif
+#if DSC_INSTANCES < 1 || DSC_INSTANCES > 4
+  #error "DSC_INSTANCES must be 1 to 4"
+#endif
+
+// Zone groups (8 zones each) with a decoder. Zones 33-64 of the 1864 are not 
+// decoded yet, so it uses the same 4 groups as the 1832
+#if DSC_ZONES > 32
+  #define DSC_ZONE_GROUPS 4
+#else
+  #define DSC_ZONE_GROUPS (DSC_ZONES / 8)
+#endif
+
+// Bytes DSCNetWriter collects before it writes them to the client. A full TCP
+// segment on Ethernet is 1460, the AVR boards keep a smaller buffer for the RAM
+#ifndef DSC_NET_BUFFER
+  #if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+    #define DSC_NET_BUFFER 512
+  #elif defined(__AVR__)
+    #define DSC_NET_BUFFER 128
+  #else
+    #define DSC_NET_BUFFER 1460
+  #endif
+#endif
+
+#endif
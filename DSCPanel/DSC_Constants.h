@@ -11,13 +11,52 @@
  
 #ifndef DSC_Constants_h
 #define DSC_Constants_h
+#include <stdint.h>
+#include "DSC_Config.h"
+
+// The decoder core (DSC_Core.h) doesn't include Arduino.h, this is the same
+// typedef as Arduino.h has (repeating it is allowed in C++)
+typedef uint8_t byte;
 
 // ----- Word/Timing Constants -----
-const byte MAX_BITS = 128;        // The length at which to overflow (max 255)
-const byte WORD_BITS = 108;       // The expected length of a word (max 255)
+const byte MAX_BITS = DSC_MAX_BITS;   // The length at which to overflow (max 255)
+const byte WORD_BITS = DSC_WORD_BITS; // The expected length of a word (max 255)
 const int NEW_WORD_INTV = 5200;   // New word indicator interval in us (Microseconds)
+                                  //   the starting gap threshold is NEW_WORD_INTV - 200,
+                                  //   until it is learned from the bus (DSC_Globals.h)
+const unsigned int GAP_LEARN_EDGES = 512; // Clock edges per gap learning pass (a few words)
+const unsigned int GAP_MIN_BIT = 100;     // Learned half periods/gaps must be above this
+const byte GAP_STALL_RATIO = 4;           // Tracked gaps over this times the shortest are stalls
 const byte ARR_SIZE = 12;         // (max 255)   // NOT USED
 
+// ----- String Buffers -----
+// The word Strings (pBuild, pWord, oldPWord and the keypad ones) are reserved at
+// MAX_BITS + 1 characters in begin(), the longest word the ISR builds, so the ISR
+// never allocates. The messages are reserved at MSG_RESERVE, a longer one grows
+const byte STRING_FIELDS = 8;     // Word and message Strings in dscGlobal_t
+const byte WORD_STRINGS = 6;      // The first 6 are words, the last 2 messages
+const byte MSG_RESERVE = 64;
+
+// ----- PANEL STATUS FLAGS -----
+// Bits of dscGlobal.pStatus, decoded from the status command [0x05]
+const byte ST_READY     = 0x01;
+const byte ST_ARMED     = 0x02;
+const byte ST_MEMORY    = 0x04;
+const byte ST_BYPASS    = 0x08;
+const byte ST_ERROR     = 0x10;
+const byte ST_PROGRAM   = 0x20;
+const byte ST_POWERFAIL = 0x40;
+
+// ----- ZONE GROUP COMMANDS -----
+// Panel commands carrying the open zones, in zone group order (zones 1-8, 9-16, etc.)
+// Only the groups the panel model can have (DSC_Config.h)
+const byte ZONE_GROUPS = DSC_ZONE_GROUPS;
+#if DSC_ZONE_GROUPS > 2
+const byte zoneCmd[ZONE_GROUPS] = { 0x27, 0x2d, 0x34, 0x3e };
+#else
+const byte zoneCmd[ZONE_GROUPS] = { 0x27, 0x2d };
+#endif
+
 // ------ HEX LOOK-UP ARRAY ------
 const char hex[] = "0123456789abcdef";  // HEX alphanumerics look-up array
 
@@ -25,7 +64,8 @@ const char hex[] = "0123456789abcdef";  // HEX alphanumerics look-up array
 const byte kOut   = 0xff;   // 11111111 Usual 1st byte from keypad
 const byte k_ff   = 0xff;   // 11111111 Keypad CRC checksum 1?
 const byte k_7f   = 0x7f;   // 01111111 Keypad CRC checksum 2?
-// The following buttons data are in the 2nd byte:
+// The following buttons data are in the 2nd byte (the keypad's check is in the
+//   bits after it, see dscKeyCheck() in DSC_Core.h):
 const byte one    = 0x82;   // 10000010
 const byte two    = 0x85;   // 10000101
 const byte three  = 0x87;   // 10000111
@@ -44,7 +84,7 @@ const byte chime  = 0xdd;   // 11011101
 const byte reset  = 0xed;   // 11101101
 const byte kExit  = 0xf0;   // 11110000
 const byte lArrow = 0xfb;   // 11111011
-const byte rArrow = 0xf7;   // 11110111
+const byte rArrow = 0xf7;   // 11110111 (can't pass the button check, not checked)
 // The following button's data are in the 1st byte, and these 
 //   seem to be sent twice, with a panel response in between:
 const byte fire   = 0xbb;   // 10111011 
@@ -0,0 +1,230 @@
+#include "DSC_Core.h"
+#include <string.h>
+
+// ----- Keypad Button Codes (2nd keypad byte, in KEY_ index order) -----
+const byte dscKeyCode[KEY_BUTTONS] DSC_ROM =
+  { one, two, three, four, five, six, seven, eight, nine, aster, zero, pound,
+    stay, away, chime, reset, kExit, lArrow, rArrow };
+
+void dscFrameClear(dscFrame_t &f)
+  {
+    memset(&f, 0, sizeof(dscFrame_t));
+  }
+
+int dscFramePush(dscFrame_t &f, byte bit)
+  {
+    if (f.len >= FRAME_BYTES * 8) return 0;   // return failure (full)
+    if (bit) f.bits[f.len >> 3] |= (0x80 >> (f.len & 7));
+    f.len++;
+    return 1;
+  }
+
+int dscFrameFromText(dscFrame_t &f, const char *text, unsigned int len)
+  {
+    dscFrameClear(f);
+    for (unsigned int i=0;i<len;i++)
+      if (!dscFramePush(f, text[i] == '1')) break;
+    return f.len;
+  }
+
+unsigned int dscFrameBits(const dscFrame_t &f, byte offset, byte count)
+  {
+    unsigned int val = 0;
+    if (count > 16) count = 16;
+    for (byte j=0;j<count;j++) {
+      unsigned int pos = offset + j;
+      val <<= 1;
+      if (pos < f.len && (f.bits[pos >> 3] & (0x80 >> (pos & 7)))) val |= 1;
+    }
+    return val;
+  }
+
+int dscFrameEqual(const dscFrame_t &a, const dscFrame_t &b)
+  {
+    if (a.len != b.len) return 0;
+    return memcmp(a.bits, b.bits, (a.len + 7) >> 3) == 0;
+  }
+
+int dscFrameHasZero(const dscFrame_t &f)
+  {
+    byte full = f.len >> 3;
+    for (byte i=0;i<full;i++)
+      if (f.bits[i] != 0xff) return 1;
+    byte rest = f.len & 7;
+    if (rest && (f.bits[full] | (0xff >> rest)) != 0xff) return 1;
+    return 0;
+  }
+
+int dscPanelChecksum(const dscFrame_t &f)
+  {
+    // Sums all but the last full byte (minus padding) and compares to last byte
+    if (f.len <= 8) return 0;
+    int grps = (f.len - 9) / 8;
+    if (grps == 0) return 0;
+    byte sum = dscFrameBits(f, 0, 8);
+    for (int i=0;i<grps-1;i++)
+      sum += dscFrameBits(f, 9 + (i * 8), 8);
+    return sum == dscFrameBits(f, 9 + ((grps - 1) * 8), 8);
+  }
+
+// Days in a month of the year 20yy (every 4th year is a leap year up to 2099)
+static byte daysInMonth(byte month, unsigned int yy)
+  {
+    static const byte days[12] = {31,28,31,30,31,30,31,31,30,31,30,31};
+    if (month == 2 && (yy % 4) == 0) return 29;
+    return days[month - 1];
+  }
+
+static byte fieldBits(byte cmd)
+  {
+    // Bits a panel word needs to hold the fields decoded for its command (the
+    // last bit read + 1), 8 for the commands with no fields
+    if (cmd == 0x05) return 30;
+    if (cmd == 0xa5) return 49;
+    for (byte grp=0;grp<ZONE_GROUPS;grp++)
+      if (cmd == zoneCmd[grp]) return 49;
+    if (cmd == 0x0a) return 25;
+    if (cmd == 0x64 || cmd == 0x69) return 17;
+    return 8;
+  }
+
+static byte lightFlags(const dscFrame_t &f)
+  {
+    // ST_ flags of the keypad lights byte (status and program mode)
+    byte st = 0;
+    if (dscFrameBits(f, 16, 1)) st |= ST_READY;
+    if (dscFrameBits(f, 12, 1)) st |= ST_ERROR;
+    if (dscFrameBits(f, 13, 1)) st |= ST_BYPASS;
+    if (dscFrameBits(f, 14, 1)) st |= ST_MEMORY;
+    if (dscFrameBits(f, 15, 1)) st |= ST_ARMED;
+    return st;
+  }
+
+byte dscDecodePanel(const dscFrame_t &f, dscPanelInfo_t &info)
+  {
+    memset(&info, 0, sizeof(dscPanelInfo_t));
+    info.zoneGroup = ZONE_NONE;
+    info.cmd = dscFrameBits(f, 0, 8);
+    if (!info.cmd) return 0;                  // return failure (empty word)
+    // A cut word would decode its missing bits as 0 (a false time or "zones
+    // closed"), so the fields are only read from a word that holds them all
+    if (f.len < fieldBits(info.cmd)) {
+      info.cmd = 0;
+      return 0;                               // return failure (word too short)
+    }
+    info.crc = dscPanelChecksum(f);
+    info.data = dscFrameBits(f, 9, 8);
+    byte cmd = info.cmd;
+
+    if (cmd == 0x05) {
+      info.status = lightFlags(f);
+      if (dscFrameBits(f, 17, 1)) info.status |= ST_PROGRAM;
+      if (dscFrameBits(f, 29, 1)) info.status |= ST_POWERFAIL;   // ??? - maybe 28 or 20?
+    }
+
+    if (cmd == 0xa5) {
+      // The year is sent as two BCD digits (20yy), the rest as binary fields
+      byte y3 = dscFrameBits(f, 9, 4);
+      byte y4 = dscFrameBits(f, 13, 4);
+      info.year = y3 * 10 + y4;
+      info.month = dscFrameBits(f, 19, 4);
+      info.day = dscFrameBits(f, 23, 5);
+      info.hour = dscFrameBits(f, 28, 5);
+      info.minute = dscFrameBits(f, 33, 6);
+      info.timeValid = (y3 <= 9 && y4 <= 9 && info.month >= 1 && info.month <= 12 &&
+                        info.day >= 1 && info.day <= daysInMonth(info.month, info.year) &&
+                        info.hour <= 23 && info.minute <= 59);
+
+      info.arm = dscFrameBits(f, 41, 2);
+      info.master = dscFrameBits(f, 43, 1);
+      byte user = dscFrameBits(f, 43, 6);     // 0-36
+      if (info.arm == 0x02) user = user - 0x19;
+      if (info.arm > 0) {
+        user += 1;                            // shift to 1-32, 33, 34
+        if (user > 34) user += 5;             // convert to system code 40, 41, 42
+      }
+      info.user = user;
+    }
+
+    for (byte grp=0;grp<ZONE_GROUPS;grp++) {
+      if (cmd != zoneCmd[grp]) continue;
+      info.zoneGroup = grp;
+      info.zones = dscFrameBits(f, 8+1+8+8+8+8, 8);
+    }
+
+    if (cmd == 0x0a) {
+      info.status = lightFlags(f) | ST_PROGRAM;
+      info.mode = dscFrameBits(f, 17, 8);
+    }
+
+    if (cmd == 0x64) info.beeps = info.data >> 1;   // The data byte holds twice the beeps
+    if (cmd == 0x69) {
+      // Tone pattern: bit 7 constant tone, bits 4-6 beeps, bits 0-3 interval (s)
+      info.beeps = (info.data >> 4) & 0x07;
+      info.tone = (info.data & 0x80) ? 1 : 0;
+      info.interval = info.data & 0x0f;
+    }
+    return cmd;
+  }
+
+int dscKeyCheck(byte b)
+  {
+    byte code = b >> 2;
+    byte sum = (code >> 4) + ((code >> 2) & 0x03) + (code & 0x03);
+    return (sum & 0x03) == (b & 0x03);
+  }
+
+byte dscDecodeKeypad(const dscFrame_t &f, byte panelCmd, dscKeypadInfo_t &info)
+  {
+    info.cmd = dscFrameBits(f, 0, 8);
+    info.data = dscFrameBits(f, 8, 8);
+    info.key = KEY_NONE;
+    info.slots = 0;
+    if (!dscFrameHasZero(f)) {
+      info.type = KPD_IDLE;
+      return 0;                               // return failure (idle, all 1's)
+    }
+
+    if (panelCmd == 0x11 && info.cmd == kOut) {
+      // Slot query reply, only the slots the word is long enough to hold
+      info.type = KPD_SLOTS;
+      for (byte i=0;i<KPD_SLOT_COUNT;i++) {
+        byte pos = 9 + (i * 2);
+        if (pos + 2 > f.len) break;
+        if (dscFrameBits(f, pos, 2) != 0x03) info.slots |= (1 << i);
+      }
+      return info.cmd;
+    }
+
+    if (info.cmd == fire || info.cmd == aux || info.cmd == panic) {
+      info.type = KPD_BUTTON;
+      info.key = (info.cmd == fire) ? KEY_FIRE : (info.cmd == aux) ? KEY_AUX : KEY_PANIC;
+      return info.cmd;
+    }
+
+    if (info.cmd != kOut) {
+      info.type = KPD_UNKNOWN;
+      return info.cmd;
+    }
+    if (info.data == kOut) {
+      info.type = KPD_RESPONSE;
+      return info.cmd;
+    }
+
+    // A button, the check needs the whole button byte. The right arrow's code
+    // can't pass the check (its check bits are 1x, its sum is 0), it is taken
+    // from the table without it as before the check was added
+    if (f.len < 17 || (info.data != rArrow && !dscKeyCheck(dscFrameBits(f, 9, 8)))) {
+      info.type = KPD_INVALID;
+      return 0;                               // return failure (garbled)
+    }
+    info.type = KPD_UNKNOWN;
+    // The arrow buttons don't work every time, they are often reversed
+    for (byte key=0;key<KEY_BUTTONS;key++)
+      if (dscRomByte(&dscKeyCode[key]) == info.data) {
+        info.key = key;
+        info.type = KPD_BUTTON;
+        break;
+      }
+    return info.cmd;
+  }
@@ -0,0 +1,152 @@
+/* DSC_Core.h
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Platform independent Keybus word decoder. It works on bit packed words
+ * (dscFrame_t) and returns the decoded fields as plain structs, with no Arduino
+ * headers, String or Print, so the same code runs in the DSC class on the MCU
+ * and in host programs (see CMakeLists.txt for the Linux static library).
+ *
+ * The DSC class is the adapter for sketches: it fills the frames from the words
+ * built by its ISR and turns the decoded fields into the pMsg/kMsg text.
+ *
+ * Usage on a host:
+ *    dscFrame_t f;  dscPanelInfo_t info;
+ *    dscFrameFromText(f, "00000101...", len);
+ *    if (dscDecodePanel(f, info) == 0x05) ...info.status...
+ */
+
+#ifndef DSC_Core_h
+#define DSC_Core_h
+#include "DSC_Constants.h"
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define DSC_ROM PROGMEM
+#define dscRomByte(addr) pgm_read_byte(addr)
+#else
+#define DSC_ROM
+#define dscRomByte(addr) (*(const byte *)(addr))
+#endif
+
+// ----- Frame Size -----
+// The ISR stops adding bits after MAX_BITS, so a word holds up to MAX_BITS + 1
+const byte FRAME_BYTES = (DSC_MAX_BITS + 1 + 7) / 8;
+
+/* A Keybus word, bit packed, first bit in the high bit of bits[0]. The bits
+ * past "len" are always 0, so frames can be compared byte by byte.
+ */
+typedef struct
+{
+  byte bits[FRAME_BYTES];
+  byte len;                       // Number of bits in the word
+}
+dscFrame_t;
+
+/* Decoded fields of a panel word. Only the fields of the word's command are
+ * set, the others are 0 (zoneGroup is ZONE_NONE if it isn't a zone command).
+ */
+const byte ZONE_NONE = 0xff;
+
+typedef struct
+{
+  byte cmd;                       // Command byte (bits 0-7), 0 if the word is empty
+  byte crc;                       // 1 if the checksum byte is valid
+  byte data;                      // First data byte (bits 9-16)
+  byte status;                    // ST_ flags: 0x05 status, 0x0a program mode lights
+  byte mode;                      // 0x0a: programming mode code
+  byte zoneGroup;                 // Zone commands: index in zoneCmd[] (A = 0)
+  byte zones;                     // Zone commands: open zones, one bit per zone
+  byte arm;                       // 0xa5: 0x02 armed, 0x03 disarmed, 0 none
+  byte master;                    // 0xa5: 1 for the master code
+  byte user;                      // 0xa5: code number (1-32, 33, 34, 40-42)
+  unsigned int year;              // 0xa5: date and time, the year is 0-99 (20yy)
+  byte month, day, hour, minute;
+  byte timeValid;                 // 0xa5: 1 if every date/time field is in range
+  byte beeps;                     // 0x64/0x69: number of beeps
+  byte tone;                      // 0x69: 1 for a constant tone
+  byte interval;                  // 0x69: seconds between the beeps
+}
+dscPanelInfo_t;
+
+/* Decoded fields of a keypad word. The keypads send in the same word period as
+ * the panel, so a word is read according to the panel command:
+ *  - Buttons: the 1st byte is kOut, the button byte is bits 9-16 (the 2nd byte
+ *    of kWord is its first 8 bits, as in DSC_Constants.h). Its upper 6 bits are
+ *    the button code and the low 2 bits are the sum of the code's three 2 bit
+ *    groups (mod 4), a word that fails this check is rejected (KPD_INVALID).
+ *    The right arrow (rArrow) never passes it and is matched without it.
+ *  - Fire/aux/panic: the button is the 1st byte.
+ *  - Reply to the panel's keypad slot query [0x11]: from bit 9, 2 bits per slot
+ *    (slots 1-8, the keypad address), 11 for an empty slot.
+ */
+const byte KPD_IDLE     = 0;      // All 1's, no keypad sent anything
+const byte KPD_BUTTON   = 1;      // A button (key) with a valid check
+const byte KPD_RESPONSE = 2;      // kOut with a 2nd byte of 0xff (no button)
+const byte KPD_SLOTS    = 3;      // Slot query reply (slots)
+const byte KPD_UNKNOWN  = 4;      // Valid check, but not a known button/word
+const byte KPD_INVALID  = 5;      // Failed the button check or too short
+
+const byte KPD_SLOT_COUNT = 8;
+const byte KEY_NONE = 0xff;
+
+// Keypad buttons, the index of the button (key) in the order of the STR_KEY_
+// strings (DSC_Strings.h): 1-9, *, 0, #, stay, away, chime, reset, exit, <, >
+const byte KEY_BUTTONS = 19;      // Buttons sent in the 2nd byte (dscKeyCode[])
+const byte KEY_FIRE    = 19;      // Buttons sent in the 1st byte
+const byte KEY_AUX     = 20;
+const byte KEY_PANIC   = 21;
+
+typedef struct
+{
+  byte type;                      // KPD_ type (above)
+  byte cmd;                       // First byte, kOut or a fire/aux/panic button
+  byte data;                      // Second byte
+  byte key;                       // Button index (above), KEY_NONE if not a button
+  byte slots;                     // KPD_SLOTS: keypads present, bit 0 for slot 1
+}
+dscKeypadInfo_t;
+
+extern const byte dscKeyCode[KEY_BUTTONS] DSC_ROM;
+
+// ----- Frames -----
+// Empties the frame
+void dscFrameClear(dscFrame_t &f);
+
+// Adds one bit at the end, returns 1 for success, 0 if the frame is full
+int dscFramePush(dscFrame_t &f, byte bit);
+
+// Fills the frame from "len" characters of '0' and '1' (other characters are 0)
+// Returns:   the number of bits in the frame (the word is cut if too long)
+int dscFrameFromText(dscFrame_t &f, const char *text, unsigned int len);
+
+// Returns "count" bits (up to 16, more are cut to 16) from "offset" as a number,
+// first bit highest. Bits past the end of the word read as 0
+unsigned int dscFrameBits(const dscFrame_t &f, byte offset, byte count);
+
+// Returns 1 if both frames hold the same word, 0 if not
+int dscFrameEqual(const dscFrame_t &a, const dscFrame_t &b);
+
+// Returns 1 if the word has a 0 bit (keypad words of all 1's are idle), 0 if not
+int dscFrameHasZero(const dscFrame_t &f);
+
+// ----- Decoding -----
+// Returns 1 if the last full byte of a panel word is the sum of the bytes
+// before it (the 9th bit is skipped), 0 if not
+int dscPanelChecksum(const dscFrame_t &f);
+
+// Returns 1 if the button byte "b" (bits 9-16 of a keypad word) passes the 2 bit
+// sum check, 0 if not
+int dscKeyCheck(byte b);
+
+// Decodes a panel word into "info"
+// Returns:   the command byte, 0 if there is none (empty word) or the word is too
+//            short to hold the fields of its command (cut off)
+byte dscDecodePanel(const dscFrame_t &f, dscPanelInfo_t &info);
+
+// Decodes a keypad word into "info", "panelCmd" is the command of the panel word
+// sent in the same word period
+// Returns:   the 1st byte, 0 if the word is idle or invalid (info.type tells)
+byte dscDecodeKeypad(const dscFrame_t &f, byte panelCmd, dscKeypadInfo_t &info);
+
+#endif
@@ -0,0 +1,167 @@
+#include "Arduino.h"
+#include "DSC_Diag.h"
+#include <TextBuffer.h>
+
+#if defined(__AVR__)
+// avr-libc heap: the heap starts at __heap_start and ends at __brkval (0 until the
+// first malloc), freed blocks are kept in the __flp list
+struct __freelist
+{
+  size_t sz;
+  struct __freelist *nx;
+};
+extern char __heap_start;
+extern char *__brkval;
+extern struct __freelist *__flp;
+extern size_t __malloc_margin;
+
+static char *heapTop(void)
+  {
+    return __brkval ? __brkval : &__heap_start;
+  }
+#endif
+
+// The boards sample() reads the heap and stack of, the others only have the counters
+#if defined(__AVR__) || defined(ESP8266) || defined(ESP32)
+#define DIAG_MEMORY 1
+#else
+#define DIAG_MEMORY 0
+#endif
+
+DSCDiag::DSCDiag(void)
+  {
+    memset(&last, 0, sizeof(dscMem_t));
+    lowFree = lowBlock = lowStack = 0xffffffffUL;
+    active = 0;
+    minFree = minBlock = minStack = 0;
+    guardFn = NULL;
+  }
+
+void DSCDiag::begin(void)
+  {
+#if defined(__AVR__)
+    // Paints from the top of the heap up to a margin below this function's frame
+    char here;
+    char *p = heapTop();
+    char *end = &here - DIAG_PAINT_MARGIN;
+    while (p < end) *p++ = DIAG_PAINT;
+#endif
+  }
+
+void DSCDiag::setGuard(unsigned long minFree, unsigned long minBlock, unsigned long minStack)
+  {
+    this->minFree = minFree;
+    this->minBlock = minBlock;
+    this->minStack = minStack;
+  }
+
+void DSCDiag::onGuard(void (*fn)(byte flags, const dscMem_t &m))
+  {
+    guardFn = fn;
+  }
+
+void DSCDiag::sample(dscMem_t &m, DSC *dsc)
+  {
+    memset(&m, 0, sizeof(dscMem_t));
+
+#if defined(__AVR__)
+    char here;
+    char *top = heapTop();
+    unsigned long gap = (&here > top) ? (unsigned long)(&here - top) : 0;
+
+    // The free list, the blocks freed below the top of the heap
+    noInterrupts();
+    for (struct __freelist *fl = __flp; fl; fl = fl->nx) {
+      m.freeHeap += fl->sz;
+      if (fl->sz > m.largestBlock) m.largestBlock = fl->sz;
+      m.freeBlocks++;
+    }
+    interrupts();
+    m.freeHeap += gap;
+    // malloc() keeps __malloc_margin bytes clear for the stack when it grows the heap
+    if (gap > __malloc_margin && gap - __malloc_margin > m.largestBlock)
+      m.largestBlock = gap - __malloc_margin;
+
+    // Painted bytes still left above the heap, up to where the stack has been
+    char *p = top;
+    while (p < &here && *p == (char)DIAG_PAINT) p++;
+    m.stackFree = p - top;
+#elif defined(ESP8266)
+    m.freeHeap = ESP.getFreeHeap();
+    m.largestBlock = ESP.getMaxFreeBlockSize();
+    m.stackFree = ESP.getFreeContStack();
+#elif defined(ESP32)
+    m.freeHeap = ESP.getFreeHeap();
+    m.largestBlock = ESP.getMaxAllocHeap();
+    m.stackFree = uxTaskGetStackHighWaterMark(NULL);
+#endif
+
+    m.tbAllocs = TextBuffer::allocCount;
+    m.tbFrees = TextBuffer::freeCount;
+    m.tbFails = TextBuffer::failCount;
+    m.tbBytes = TextBuffer::allocBytes;
+    if (dsc) {
+      m.strAllocs = dsc->dscGlobal.strAllocs;
+      m.strFails = dsc->dscGlobal.strFails;
+    }
+  }
+
+byte DSCDiag::check(DSC &dsc)
+  {
+    sample(last, &dsc);
+    if (last.freeHeap < lowFree) lowFree = last.freeHeap;
+    if (last.largestBlock < lowBlock) lowBlock = last.largestBlock;
+    if (last.stackFree < lowStack) lowStack = last.stackFree;
+
+    // The memory values are 0 on the other boards, not a reason for a warning
+    byte now = 0;
+    if (DIAG_MEMORY && minFree && last.freeHeap < minFree) now |= DIAG_LOW_HEAP;
+    if (DIAG_MEMORY && minBlock && last.largestBlock < minBlock) now |= DIAG_FRAGMENTED;
+    if (DIAG_MEMORY && minStack && last.stackFree < minStack) now |= DIAG_LOW_STACK;
+    if (last.tbFails || last.strFails) now |= DIAG_ALLOC_FAIL;
+
+    // Only the flags that were not crossed already, a flag re-arms when it clears
+    byte crossed = now & ~active;
+    active = now;
+    if (crossed && guardFn) guardFn(crossed, last);
+    return crossed;
+  }
+
+void DSCDiag::print(Print &out)
+  {
+    out.print(F("Free heap: "));
+    out.print(last.freeHeap);
+    out.print(F(" (low "));
+    out.print(lowFree);
+    out.print(F("), largest block: "));
+    out.print(last.largestBlock);
+    out.print(F(" (low "));
+    out.print(lowBlock);
+    out.print(F("), free blocks: "));
+    out.println(last.freeBlocks);
+    out.print(F("Stack never used: "));
+    out.print(last.stackFree);
+    out.print(F(" (low "));
+    out.print(lowStack);
+    out.println(F(")"));
+    out.print(F("TextBuffer allocs: "));
+    out.print(last.tbAllocs);
+    out.print(F(", frees: "));
+    out.print(last.tbFrees);
+    out.print(F(", failed: "));
+    out.print(last.tbFails);
+    out.print(F(", bytes: "));
+    out.println(last.tbBytes);
+    out.print(F("DSC String allocs: "));
+    out.print(last.strAllocs);
+    out.print(F(", failed: "));
+    out.println(last.strFails);
+    if (active) {
+      out.print(F("Guard:"));
+      if (active & DIAG_LOW_HEAP) out.print(F(" low heap"));
+      if (active & DIAG_FRAGMENTED) out.print(F(" fragmented"));
+      if (active & DIAG_LOW_STACK) out.print(F(" low stack"));
+      if (active & DIAG_ALLOC_FAIL) out.print(F(" alloc failed"));
+      out.println();
+    }
+  }
@@ -0,0 +1,104 @@
+/* DSC_Diag.h
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Memory diagnostics for long uptimes. A sample holds the free heap, the largest
+ * block malloc() can still hand out (the heap is fragmented when it is much
+ * smaller than the free heap), the stack high water mark and the allocation
+ * counters of the TextBuffers and of the DSC word/message Strings.
+ *
+ * The stack high water mark works by stack painting: begin() fills the free RAM
+ * between the heap and the stack with DIAG_PAINT, and the painted bytes still
+ * left above the heap are the space the stack never reached. Call begin() first
+ * thing in setup(), before the buffers are allocated.
+ *
+ * The guard compares each sample to configurable thresholds and reports (flags
+ * returned by check(), and the guard hook) when one is crossed, once per
+ * crossing, so the warning comes while there is still memory to report it.
+ *
+ * AVR: all values. ESP8266/ESP32: the SDK's heap values and stack free space.
+ * Other boards: the counters only (the memory values are 0, the guard only
+ * checks for failed allocations).
+ *
+ * Usage:
+ *    DSCDiag diag;
+ *    diag.begin();  diag.setGuard(256, 128, 128);     (first in setup())
+ *    if (diag.check(dsc)) diag.print(Serial);        (every few seconds)
+ */
+
+#ifndef DSC_Diag_h
+#define DSC_Diag_h
+#include "DSC.h"
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+const byte DIAG_PAINT = 0xc5;           // Stack paint pattern
+const byte DIAG_PAINT_MARGIN = 32;      // Bytes left unpainted below the stack pointer
+
+// ----- Guard Flags (returned by check()) -----
+const byte DIAG_LOW_HEAP   = 0x01;      // Free heap below the minimum
+const byte DIAG_FRAGMENTED = 0x02;      // Largest free block below the minimum
+const byte DIAG_LOW_STACK  = 0x04;      // Stack came closer than the minimum to the heap
+const byte DIAG_ALLOC_FAIL = 0x08;      // A TextBuffer or String reserve failed
+
+typedef struct
+{
+  unsigned long freeHeap;         // Free heap, bytes (free list and unused gap)
+  unsigned long largestBlock;     // Largest block malloc() can return
+  unsigned int freeBlocks;        // Blocks in the free list (fragments, AVR)
+  unsigned long stackFree;        // Stack high water mark: bytes never reached
+
+  unsigned int tbAllocs;          // TextBuffer begin() calls (all TextBuffers)
+  unsigned int tbFrees;           // TextBuffer end() calls
+  unsigned int tbFails;           // TextBuffer begin() calls that failed
+  unsigned long tbBytes;          // Bytes held by TextBuffers now
+  unsigned int strAllocs;         // DSC String (re)allocations (dscGlobal.strAllocs)
+  byte strFails;                  // DSC String reserves that failed
+}
+dscMem_t;
+
+class DSCDiag
+{
+  public:
+    // Class to call to initialize the diagnostics
+    // for example...  DSCDiag diag;
+    DSCDiag(void);
+
+    // Paints the free RAM for the stack high water mark (first thing in setup())
+    void begin(void);
+
+    // Sets the guard thresholds in bytes, 0 to turn a check off
+    void setGuard(unsigned long minFree, unsigned long minBlock, unsigned long minStack);
+
+    // Registers the function called by check() when a threshold is crossed
+    void onGuard(void (*fn)(byte flags, const dscMem_t &m));
+
+    // Takes a sample of the memory values and counters into "m" (the DSC counters
+    // are left 0 without "dsc")
+    void sample(dscMem_t &m, DSC *dsc = NULL);
+
+    // Samples (into "last"), updates the low water marks and runs the guard
+    // Returns:   the DIAG_ flags crossed by this sample, 0 if none (a flag is
+    //            returned again only after the value recovered)
+    byte check(DSC &dsc);
+
+    // Prints a sample and the low water marks as text lines, to Serial or as the
+    // body of an HTTP reply (any Print)
+    void print(Print &out);
+
+    dscMem_t last;                  // Last sample taken by check()
+    unsigned long lowFree;          // Lowest free heap seen by check()
+    unsigned long lowBlock;         // Smallest largest block seen by check()
+    unsigned long lowStack;         // Lowest stack high water mark seen by check()
+    byte active;                    // DIAG_ flags currently crossed
+
+  private:
+    unsigned long minFree, minBlock, minStack;
+    void (*guardFn)(byte flags, const dscMem_t &m);
+};
+
+#endif
@@ -0,0 +1,77 @@
+#include "Arduino.h"
+#include "DSC_Events.h"
+#include "DSC_Constants.h"
+
+int dscCritical(byte src, byte cmd, byte data)
+  {
+    if (src == EVT_KEYPAD)
+      return (cmd == fire || cmd == aux || cmd == panic);
+    if (cmd == 0x5d || cmd == 0x63) return 1;         // Alarm memory groups
+    if (cmd == 0xa5 && data >= 0x02) return 1;        // Armed (0x02) or disarmed (0x03)
+    return 0;
+  }
+
+DSCEventQueue::DSCEventQueue(void)
+  {
+    clear();
+    coalesced = 0;
+    dropped = 0;
+  }
+
+int DSCEventQueue::push(const dscEvent_t &evt, bool critical)
+  {
+    if (critical) {
+      if (critCount >= EVT_CRIT_SIZE) {
+        dropped++;
+        return 0;                 // return failure (full)
+      }
+      crit[(critHead + critCount) % EVT_CRIT_SIZE] = evt;
+      critCount++;
+      return 1;
+    }
+    
+    // Coalesce with a queued event of the same source and command
+    for (byte i=0;i<count;i++) {
+      dscEvent_t &q = routine[(head + i) % EVT_QUEUE_SIZE];
+      if (q.src == evt.src && q.cmd == evt.cmd) {
+        q = evt;
+        coalesced++;
+        return 1;
+      }
+    }
+    if (count >= EVT_QUEUE_SIZE) {
+      dropped++;
+      return 0;                   // return failure (full)
+    }
+    routine[(head + count) % EVT_QUEUE_SIZE] = evt;
+    count++;
+    return 1;
+  }
+
+int DSCEventQueue::pop(dscEvent_t &evt)
+  {
+    if (critCount) {
+      evt = crit[critHead];
+      critHead = (critHead + 1) % EVT_CRIT_SIZE;
+      critCount--;
+      return 1;
+    }
+    if (count) {
+      evt = routine[head];
+      head = (head + 1) % EVT_QUEUE_SIZE;
+      count--;
+      return 1;
+    }
+    return 0;                     // return failure (empty)
+  }
+
+byte DSCEventQueue::available(void)
+  {
+    return critCount + count;
+  }
+
+void DSCEventQueue::clear(void)
+  {
+    critHead = 0, critCount = 0;
+    head = 0, count = 0;
+  }
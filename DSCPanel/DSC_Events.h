@@ -0,0 +1,87 @@
+/* DSC_Events.h
+ * Part of DSC Library 
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Two level event queue for decoded words. Alarm-critical events (fire, aux and 
+ * panic keys, alarm memory, arm/disarm) are handed to the callback registered 
+ * with DSC.onCritical() from within process(), before any message formatting,
+ * so the time to notify is bounded by one process() call. Without a callback
+ * they go to the critical level of the queue, which is always read first.
+ *
+ * Routine events (status, zones, keypad buttons, etc.) are deferred to the 
+ * queue and coalesced: a newer event of the same source and command replaces 
+ * the queued one, so a chatty bus can't fill the queue with stale words.
+ *
+ * Usage:
+ *    DSCEventQueue events;
+ *    dsc.setQueue(events);   dsc.onCritical(alarmHandler);
+ *    dsc.process();  while (events.pop(evt)) { ... }
+ */
+
+#ifndef DSC_Events_h
+#define DSC_Events_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+// ----- Event Sources -----
+const byte EVT_PANEL  = 1;
+const byte EVT_KEYPAD = 2;
+
+// ----- Queue Sizes -----
+const byte EVT_CRIT_SIZE  = 4;      // Critical events (only used without a callback)
+const byte EVT_QUEUE_SIZE = 8;      // Routine events, one per source/command at most
+
+// A critical event (same source, command and data) seen again within this many
+// ms of the last time it was seen is the same event, it isn't handed over again
+const unsigned long EVT_REPEAT_MS = 60000;
+
+typedef struct
+{
+  byte src;             // EVT_PANEL or EVT_KEYPAD
+  byte cmd;             // Command byte of the word
+  byte data;            // Panel: 1st data byte (arm state for 0xa5), Keypad: 2nd byte
+  unsigned long time;   // millis() when the word was decoded
+}
+dscEvent_t;
+
+// Returns 1 if the event is alarm-critical, 0 if it is routine
+int dscCritical(byte src, byte cmd, byte data);
+
+class DSCEventQueue
+{
+  public:
+    // Class to call to initialize the queue
+    // for example...  DSCEventQueue events;
+    DSCEventQueue(void);
+    
+    // Adds an event to the critical or the routine level. Routine events replace
+    // a queued event with the same source and command
+    // Returns:   1 if added or coalesced, 0 if the level was full (event dropped)
+    int push(const dscEvent_t &evt, bool critical);
+    
+    // Takes the oldest critical event, or the oldest routine event if there are
+    // no critical ones. Returns 1 if an event was copied into "evt", 0 if empty
+    int pop(dscEvent_t &evt);
+    
+    // Returns the number of queued events (both levels)
+    byte available(void);
+    
+    // Empties both levels
+    void clear(void);
+    
+    // ----- Counters -----
+    unsigned int coalesced;       // Routine events replaced by a newer one
+    unsigned int dropped;         // Events lost because a level was full
+    
+  private:
+    dscEvent_t crit[EVT_CRIT_SIZE];
+    byte critHead, critCount;
+    dscEvent_t routine[EVT_QUEUE_SIZE];
+    byte head, count;
+};
+
+#endif
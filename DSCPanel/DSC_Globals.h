@@ -2,15 +2,17 @@
  * Part of DSC Library 
  * See COPYRIGHT.txt and LICENSE.txt for more information.
  *
- * It contains definition of global items which are used by the DSC class.
- * They have to be declared global in scope because they are accessed by
- * the ISR and you cannot pass parameters nor objects to an ISR routine.
+ * It contains definition of the items which are used by the DSC class and 
+ * its ISR. Each DSC object has its own dscGlobal_t, taken from a fixed pool
+ * (dscState) so the ISR trampolines can reach it without passing parameters.
  * 
  * In general, applications would not include this file. 
  */
 #ifndef DSC_Globals_h
 #define DSC_Globals_h
 #include <Arduino.h>
+#include "DSC_Constants.h"
+#include "DSC_Core.h"
 
 /* Timing data is stored in a buffer by the receiver object. It is an array of
  * uint16_t that should be at least 100 entries as defined by this default below.
@@ -33,12 +35,6 @@
 #endif
  */
 
-// ----- Input/Output Pins -----
-extern byte CLK;         // Keybus Yellow (Clock Line)
-extern byte DTA_IN;      // Keybus Green (Data Line via V divider)
-extern byte DTA_OUT;     // Keybus Green Output (Data Line through driver)
-extern byte LED;         // LED pin on the arduino
-
 /*
 // Receiver states. This previously was enum but changed it to uint8_t
 // to guarantee it was a single atomic 8-bit value.
@@ -51,9 +47,87 @@ extern byte LED;         // LED pin on the arduino
 typedef uint8_t  currentState_t;
 */
 
-/* The structure contains information used by the ISR routine. Because we cannot
- * pass parameters to an ISR, vars must be global. Values which can be changed by
- * the ISR but are accessed outside the ISR must be volatile (for the most part)
+/* Clock timing of one Keybus word, accumulated by the ISR edge by edge and saved
+ * when the new word gap is seen. Every update is a handful of adds/compares so it
+ * can run on each clock edge. Times are in us (Microseconds).
+ */
+const byte TIMING_BINS = 16;      // Histogram bins of the clock half period
+const byte TIMING_BIN_SHIFT = 6;  // Bin width is 64 us (1 << 6), 16 bins cover 0-1023 us
+
+typedef struct
+{
+  unsigned int edges;             // Number of clock edges in the word
+  unsigned int minIntv;           // Shortest clock half period
+  unsigned int maxIntv;           // Longest clock half period
+  unsigned long sumIntv;          // Sum of the half periods (for the average)
+  unsigned long highTime;         // Total time the clock line was high
+  unsigned long gap;              // Length of the new word gap that ended the word
+  byte hist[TIMING_BINS];         // Half period histogram (edge counts per bin)
+}
+dscTiming_t;
+
+/* Bus utilization of one window (about a second), see DSC::analyze(). While the
+ * analyzer is on, the ISR adds the timing of each word to the window when its new
+ * word gap is seen, process() counts the words it took and busSummary() closes
+ * the window. A window without clock edges (the bus stalled) is told apart from
+ * one whose words came but were not taken in time (the capture missed them).
+ */
+const byte BUS_STALL    = 0x01;   // No clock edge for the whole window
+const byte BUS_CLK_HIGH = 0x02;   // With BUS_STALL: the clock stopped high (low if not)
+const byte BUS_NO_GAP   = 0x04;   // Clock running for half the window without a new
+                                  // word gap (a word is ~0.1 s, see dscGap_t)
+const byte BUS_MISSED   = 0x08;   // Words seen by the ISR that process() didn't take
+                                  // (a word whose gap came just before the window
+                                  // closed is carried over, not missed)
+const unsigned int BUS_WINDOW_MS = 1000;
+
+typedef struct
+{
+  unsigned long ms;               // Length of the window
+  unsigned int words;             // New word gaps seen by the ISR
+  unsigned int taken;             // Words taken by process()
+  unsigned int missed;            // Words not taken, over this and the last window
+  unsigned long edges;            // Clock edges in the words (two per bit)
+  unsigned long wordTime;         // Time in the words (sum of the half periods, us)
+  unsigned long highTime;         // Clock high time in the words (us)
+  unsigned long gapTime;          // Sum of the new word gaps (us)
+  unsigned long minGap, maxGap;
+  byte minBits, maxBits;          // Shortest and longest word (bits)
+  unsigned long keypadBits;       // Bits a keypad pulled low (the data line idles high)
+  unsigned long idle;             // Time since the last clock edge at the end (us)
+  byte flags;                     // BUS_ flags
+}
+dscBus_t;
+
+/* New word gap threshold, learned by the ISR. The clock half period and the new
+ * word gap are far apart (about 0.5 ms vs 5 ms and more), so the threshold is put
+ * half way between the longest half period and the shortest gap seen:
+ *   pass 1: the longest interval of GAP_LEARN_EDGES edges (a gap)
+ *   pass 2: intervals under half of that are half periods, the others are gaps,
+ *           keeping the longest half period and the shortest gap
+ * After that both are tracked word by word with slow running estimators, gaps
+ * over GAP_STALL_RATIO times the shortest (bus stalls) are left out. A word
+ * that overflows MAX_BITS (gaps being missed) starts the learning again.
+ */
+const byte GAP_LEARN_1 = 0;       // Learning the longest interval
+const byte GAP_LEARN_2 = 1;       // Learning the longest half period and shortest gap
+const byte GAP_TRACK   = 2;       // Learned, tracking
+
+typedef struct
+{
+  unsigned long thresh;           // Current gap threshold (us)
+  unsigned long longest;          // Pass 1: longest interval
+  unsigned int maxBit;            // Longest clock half period (running max)
+  unsigned long minGap;           // Shortest new word gap (running min)
+  unsigned int edges;             // Edges seen in the current pass
+  byte state;                     // GAP_LEARN_1, GAP_LEARN_2 or GAP_TRACK
+  byte relearns;                  // Times the learning restarted (saturating)
+}
+dscGap_t;
+
+/* The structure contains information used by the ISR routine, one per DSC object.
+ * Values which can be changed by the ISR but are accessed outside the ISR must 
+ * be volatile (for the most part)
  */
  
 typedef struct 
@@ -63,6 +137,20 @@ typedef struct
   String kBuild, kWord, oldKWord, kMsg;
   byte pCmd, kCmd;
   
+  // ----- Decoded Panel State (kept until the panel sends an update) -----
+  byte pStatus;                 // Status flags from 0x05 (ST_READY, ST_ARMED, etc.)
+  byte zones[ZONE_GROUPS];      // Open zones, one bit per zone, from the zone group commands
+  byte armState;                // From 0xa5: 0x02 armed, 0x03 disarmed, 0 no arm info
+  byte armUser;                 // From 0xa5: user code number (1-32, 33, 34, 40-42)
+  byte kSlots;                  // Keypads present (bit 0 for slot 1), from the 0x11 replies
+  unsigned int kInvalid;        // Keypad words rejected by the button check
+  unsigned int pFiltered;       // Words dropped by the command filter (saturating)
+  unsigned int kFiltered;
+  
+  // ----- String Buffers (reserved in DSC::begin()) -----
+  unsigned int strAllocs;       // String buffer (re)allocations seen, reserves included
+  byte strFails;                // Reserves that failed (out of memory)
+  
   // ----- Time Variables -----
   unsigned long lastStatus;
   unsigned long lastData;
@@ -70,16 +158,29 @@ typedef struct
   volatile unsigned long intervalTimer;   
   volatile unsigned long clockChange;
   volatile unsigned long lastChange;      
-  volatile unsigned long lastRise;        // NOT USED
-  volatile unsigned long lastFall;        // NOT USED
+  volatile unsigned long lastRise;        // Time of the last rising clock edge
+  volatile unsigned long lastFall;        // Time of the last falling clock edge
+  
+  // Word timing, modified within ISR (only copy with interrupts off)
+  dscTiming_t tBuild;                     // Timing of the word being built
+  dscTiming_t tWord;                      // Timing of the last complete word
+  volatile bool newTiming;                // Set when tWord is updated
+  
+  volatile bool newWord;                  // Set on a new word gap, cleared by process()
+  
+  // Bus analyzer window, modified within ISR while busOn (only copy with interrupts off)
+  dscBus_t bus;
+  volatile bool busOn;
   
-  volatile bool newWord;                  // NOT USED
+  // New word gap threshold learning, modified within ISR (only copy with interrupts off)
+  dscGap_t gapEst;
   
-  // ----- Byte Arrays -----
-  byte pBytes[];  // NOT USED
-  byte kBytes[];  // NOT USED
+  // ----- Bit Packed Words -----
+  // The words being decoded, filled from pWord/kWord for the decoder core
+  dscFrame_t pFrame, kFrame;
 } 
 dscGlobal_t;
-extern  dscGlobal_t dscGlobal;  //declared in DSC.cpp
+extern  dscGlobal_t dscState[DSC_INSTANCES];  // One per DSC object, declared in DSC.cpp
+extern  dscGlobal_t &dscGlobal;    // The first DSC object's state (dscState[0])
 
 #endif
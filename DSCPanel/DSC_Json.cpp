@@ -0,0 +1,215 @@
+#include "Arduino.h"
+#include "DSC_Json.h"
+
+DSCJson::DSCJson(Print &out)
+  {
+    output = &out;
+    depth = 0;
+    first = 0;
+    afterKey = false;
+    byteCount = 0;
+  }
+
+void DSCJson::setOutput(Print &out)
+  {
+    output = &out;
+  }
+
+int DSCJson::panel(DSC &dsc)
+  {
+    byte cmd = dsc.dscGlobal.pCmd;
+    if (!cmd) return 0;             // return failure
+    
+    beginObject();
+    key("src");   value(F("panel"));
+    key("cmd");   value((long)cmd);
+    key("bytes"); bitsHex(dsc.dscGlobal.pWord, 9);
+    key("msg");   value(dsc.dscGlobal.pMsg);
+    key("crc");   value((bool)dsc.pnlChkSum(dsc.dscGlobal.pWord));
+    
+    if (cmd == 0x05) {
+      byte st = dsc.dscGlobal.pStatus;
+      key("status");
+      beginObject();
+      key("ready");   value((bool)(st & ST_READY));
+      key("armed");   value((bool)(st & ST_ARMED));
+      key("memory");  value((bool)(st & ST_MEMORY));
+      key("bypass");  value((bool)(st & ST_BYPASS));
+      key("error");   value((bool)(st & ST_ERROR));
+      key("program"); value((bool)(st & ST_PROGRAM));
+      key("powerFail"); value((bool)(st & ST_POWERFAIL));
+      endObject();
+    }
+    
+    for (byte grp=0;grp<ZONE_GROUPS;grp++) {
+      if (cmd != zoneCmd[grp]) continue;
+      key("zones");                 // Open zone numbers
+      beginArray();
+      for (byte i=0;i<8;i++)
+        if (dsc.dscGlobal.zones[grp] & (1 << i)) value((long)(grp * 8) + i + 1);
+      endArray();
+    }
+    
+    if (cmd == 0xa5) {
+      if (dsc.dscGlobal.armState) {
+        key("arm");  value((dsc.dscGlobal.armState == 0x02) ? F("armed") : F("disarmed"));
+        key("user"); value((long)dsc.dscGlobal.armUser);
+      }
+      if (dsc.timeAvailable) {      // Left out if the fields were out of range
+        key("time");
+        beginObject();
+        key("y");   value((long)dsc.yy + 2000);
+        key("m");   value((long)dsc.mm);
+        key("d");   value((long)dsc.dd);
+        key("H");   value((long)dsc.HH);
+        key("M");   value((long)dsc.MM);
+        endObject();
+      }
+    }
+    
+    endObject();
+    byteCount += output->println();
+    return 1;
+  }
+
+int DSCJson::keypad(DSC &dsc)
+  {
+    byte cmd = dsc.dscGlobal.kCmd;
+    if (!cmd) return 0;             // return failure
+    
+    beginObject();
+    key("src");   value(F("keypad"));
+    key("cmd");   value((long)cmd);
+    key("bytes"); bitsHex(dsc.dscGlobal.kWord, 8);
+    key("msg");   value(dsc.dscGlobal.kMsg);
+    if (cmd == fire || cmd == aux || cmd == panic) {
+      key("alarm");
+      value((cmd == fire) ? F("fire") : (cmd == aux) ? F("aux") : F("panic"));
+    }
+    endObject();
+    byteCount += output->println();
+    return 1;
+  }
+
+void DSCJson::beginObject(void)
+  {
+    separator();
+    byteCount += output->write('{');
+    if (depth < JSON_MAX_DEPTH) first |= (1 << depth);
+    depth++;
+  }
+
+void DSCJson::endObject(void)
+  {
+    if (depth) depth--;
+    byteCount += output->write('}');
+  }
+
+void DSCJson::beginArray(void)
+  {
+    separator();
+    byteCount += output->write('[');
+    if (depth < JSON_MAX_DEPTH) first |= (1 << depth);
+    depth++;
+  }
+
+void DSCJson::endArray(void)
+  {
+    if (depth) depth--;
+    byteCount += output->write(']');
+  }
+
+void DSCJson::key(const char *name)
+  {
+    separator();
+    byteCount += output->write('"');
+    while (*name) escaped(*name++);
+    byteCount += output->write('"');
+    byteCount += output->write(':');
+    afterKey = true;
+  }
+
+void DSCJson::value(const char *str)
+  {
+    separator();
+    byteCount += output->write('"');
+    if (str) while (*str) escaped(*str++);
+    byteCount += output->write('"');
+  }
+
+void DSCJson::value(const __FlashStringHelper *str)
+  {
+    separator();
+    byteCount += output->write('"');
+    PGM_P p = reinterpret_cast<PGM_P>(str);
+    char c;
+    while ((c = pgm_read_byte(p++))) escaped(c);
+    byteCount += output->write('"');
+  }
+
+void DSCJson::value(const String &str)
+  {
+    separator();
+    byteCount += output->write('"');
+    for (unsigned int i=0;i<str.length();i++) escaped(str[i]);
+    byteCount += output->write('"');
+  }
+
+void DSCJson::value(long num)
+  {
+    separator();
+    byteCount += output->print(num);
+  }
+
+void DSCJson::value(bool b)
+  {
+    separator();
+    byteCount += b ? output->print(F("true")) : output->print(F("false"));
+  }
+
+void DSCJson::separator(void)
+  {
+    if (afterKey) {                 // Value of a key, the key had the separator
+      afterKey = false;
+      return;
+    }
+    if (depth == 0) return;         // Top level, a single value
+    byte bit = (depth <= JSON_MAX_DEPTH) ? (1 << (depth - 1)) : 0;
+    if (first & bit) first &= ~bit;
+    else byteCount += output->write(',');
+  }
+
+void DSCJson::escaped(char c)
+  {
+    // Escapes quotes, backslash and control characters, everything else is
+    // written as is (the decoded messages are plain ASCII)
+    if (c == '"' || c == '\\') {
+      byteCount += output->write('\\');
+      byteCount += output->write(c);
+    }
+    else if ((byte)c < 0x20) {
+      byteCount += output->print(F("\\u00"));
+      byteCount += output->write(hex[(c >> 4) & 0x0f]);
+      byteCount += output->write(hex[c & 0x0f]);
+    }
+    else byteCount += output->write(c);
+  }
+
+void DSCJson::bitsHex(String &dataStr, int offset)
+  {
+    // Writes the word as a string of hex bytes, the first byte is the command, 
+    // then 8 bit groups from "offset" (9 for the panel, skipping the stop bit)
+    separator();
+    byteCount += output->write('"');
+    unsigned int len = dataStr.length();
+    for (unsigned int i=0;i+8<=len;i+=8) {
+      if (i == 8) i = offset;       // Jump to the data bytes after the command byte
+      if (i + 8 > len) break;
+      byte b = 0;
+      for (byte j=0;j<8;j++) b = (b << 1) | (dataStr[i+j] == '1');
+      if (i) byteCount += output->write(' ');
+      byteCount += output->write(hex[b >> 4]);
+      byteCount += output->write(hex[b & 0x0f]);
+    }
+    byteCount += output->write('"');
+  }
@@ -0,0 +1,78 @@
+/* DSC_Json.h
+ * Part of DSC Library 
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Streaming JSON encoder for the decoded panel and keypad words. Fields are 
+ * written one by one straight to a Print (Serial, EthernetClient, TextBuffer),
+ * the document is never held in RAM. Strings are escaped as they are written.
+ *
+ * One object per line, for example:
+ *    {"src":"panel","cmd":5,"bytes":"05 81 01 10","msg":"[Status] Ready",
+ *     "status":{"ready":true,"armed":false,...}}
+ *
+ * Every "status" member is true when its ST_ flag is set, so "powerFail" is
+ * true on a power failure (AC or battery trouble), the same as the MQTT
+ * status/power topic of DSCPublisher.
+ *
+ * Usage:
+ *    DSCJson json(Serial);
+ *    json.panel(dsc);  json.keypad(dsc);    (after dsc.process())
+ */
+
+#ifndef DSC_Json_h
+#define DSC_Json_h
+#include "DSC.h"
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+const byte JSON_MAX_DEPTH = 8;      // Nesting levels tracked (one bit each)
+
+class DSCJson
+{
+  public:
+    // Class to call to initialize the encoder with its output
+    // for example...  DSCJson json(Serial);
+    DSCJson(Print &out);
+    
+    // Changes the output (for example to a newly connected client)
+    void setOutput(Print &out);
+    
+    // Writes the current panel or keypad word as one JSON object and a newline
+    // Returns 0 if there is no decoded word (pCmd/kCmd is 0), 1 if written
+    int panel(DSC &dsc);
+    int keypad(DSC &dsc);
+    
+    // ----- Low level streaming functions -----
+    // Objects and arrays, a key is required before each value inside an object
+    void beginObject(void);
+    void endObject(void);
+    void beginArray(void);
+    void endArray(void);
+    void key(const char *name);
+    
+    // Values
+    void value(const char *str);
+    void value(const __FlashStringHelper *str);
+    void value(const String &str);
+    void value(long num);
+    void value(bool b);
+    
+    // Bytes written since the encoder was created
+    unsigned long byteCount;
+    
+  private:
+    void separator(void);           // Writes "," if this isn't the first item
+    void escaped(char c);           // Writes one character of a string, escaped
+    void bitsHex(String &dataStr, int offset);  // Writes 8 bit groups in hex
+    
+    Print *output;
+    byte depth;
+    byte first;                     // Bit per depth, set until the first item is written
+    bool afterKey;                  // A key was just written, no separator before the value
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "Arduino.h"
+#include "DSC_NetWriter.h"
+
+DSCNetWriter::DSCNetWriter(void)
+  {
+    client = NULL;
+    len = 0;
+    first = 0;
+    flushSize = DSC_NET_BUFFER;
+    flushMs = NET_FLUSH_MS;
+    bytes = packets = writes = 0;
+    bySize = byTime = forced = 0;
+    dropped = 0;
+  }
+
+void DSCNetWriter::begin(Client &c)
+  {
+    dropped += len;
+    len = 0;
+    client = &c;
+  }
+
+void DSCNetWriter::end(void)
+  {
+    flush();
+    client = NULL;
+  }
+
+void DSCNetWriter::setFlush(unsigned int size, unsigned int ms)
+  {
+    if (size < 1 || size > DSC_NET_BUFFER) size = DSC_NET_BUFFER;
+    flushSize = size;
+    flushMs = ms;
+    if (len >= flushSize) {
+      bySize++;
+      send();
+    }
+  }
+
+size_t DSCNetWriter::write(uint8_t c)
+  {
+    return write(&c, 1);
+  }
+
+size_t DSCNetWriter::write(const uint8_t *buffer, size_t size)
+  {
+    if (!client || !client->connected()) {
+      dropped += size + len;      // Nobody to send to, what is buffered goes too
+      len = 0;
+      return 0;                   // return failure (not connected)
+    }
+    writes++;
+    size_t done = 0;
+    while (done < size) {
+      if (!len) first = millis();
+      unsigned int n = flushSize - len;       // len is always below flushSize
+      if (n > size - done) n = size - done;
+      memcpy(buf + len, buffer + done, n);
+      len += n;
+      done += n;
+      if (len >= flushSize) {
+        bySize++;
+        send();
+      }
+    }
+    return done;
+  }
+
+void DSCNetWriter::flush(void)
+  {
+    if (!len) return;
+    forced++;
+    send();
+  }
+
+unsigned int DSCNetWriter::poll(void)
+  {
+    if (!len || !flushMs || (millis() - first) < flushMs) return 0;
+    byTime++;
+    return send();
+  }
+
+unsigned int DSCNetWriter::pending(void)
+  {
+    return len;
+  }
+
+unsigned int DSCNetWriter::send(void)
+  {
+    unsigned int n = len;
+    len = 0;
+    if (!client || !client->connected()) {
+      dropped += n;
+      return 0;                   // return failure (not connected)
+    }
+    unsigned int sent = client->write(buf, n);
+    packets++;
+    bytes += sent;
+    if (sent < n) dropped += n - sent;
+    return sent;
+  }
+
+void DSCNetWriter::printStats(Print &out)
+  {
+    out.print(F("Net bytes: "));
+    out.print(bytes);
+    out.print(F(", packets: "));
+    out.print(packets);
+    out.print(F(" (size "));
+    out.print(bySize);
+    out.print(F(", time "));
+    out.print(byTime);
+    out.print(F(", forced "));
+    out.print(forced);
+    out.print(F("), writes: "));
+    out.print(writes);
+    out.print(F(", dropped: "));
+    out.println(dropped);
+  }
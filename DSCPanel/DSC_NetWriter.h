@@ -0,0 +1,93 @@
+/* DSC_NetWriter.h
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Buffered network output. Every client.write() on a W5100 shield is its own SPI
+ * burst and its own TCP packet (the shield sends at once, there is no Nagle
+ * delay to merge small writes), so a message line per word means a packet of
+ * 50 bytes per word. DSCNetWriter is a Print that collects the writes in a fixed
+ * buffer (DSC_NET_BUFFER, see DSC_Config.h) and writes them to the client as one
+ * packet when:
+ *    - the buffer holds "size" bytes (setFlush(), the whole buffer by default)
+ *    - the oldest byte has waited "ms" (checked by poll(), 50 ms by default)
+ *    - flush() is called, for the alarm-critical events that must not wait
+ *
+ * Writes made while no client is connected are dropped (and counted), the sketch
+ * doesn't need to check the connection before each message.
+ *
+ * Usage:
+ *    DSCNetWriter net;
+ *    net.begin(client);                    (when the client connects)
+ *    net.print(message);                   (any Print output)
+ *    net.poll();                           (every loop, or a scheduler task)
+ *    net.flush();                          (on an alarm-critical event)
+ */
+
+#ifndef DSC_NetWriter_h
+#define DSC_NetWriter_h
+#include "DSC_Config.h"
+#include "Client.h"
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+const unsigned int NET_FLUSH_MS = 50;   // Default time a byte may wait
+
+class DSCNetWriter : public Print
+{
+  public:
+    // Class to call to initialize the network writer
+    // for example...  DSCNetWriter net;
+    DSCNetWriter(void);
+
+    // Sets the client to write to, anything still buffered for the last one is
+    // discarded
+    void begin(Client &c);
+
+    // Writes what is buffered and stops writing to the client
+    void end(void);
+
+    // Writes the buffer when it holds "size" bytes (up to DSC_NET_BUFFER) or its
+    // oldest byte has waited "ms" milliseconds (0 to only flush by size)
+    void setFlush(unsigned int size, unsigned int ms);
+
+    // ----- Print class extension -----
+    virtual size_t write(uint8_t);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+
+    // Writes what is buffered now, as one packet
+    virtual void flush(void);
+
+    // Writes the buffer if its oldest byte has waited long enough
+    // Returns:   the number of bytes written, 0 if it was not time yet
+    unsigned int poll(void);
+
+    // Returns the number of bytes waiting in the buffer
+    unsigned int pending(void);
+
+    // Prints the counters below (print() is the Print output to the client)
+    void printStats(Print &out);
+
+    // ----- Counters -----
+    unsigned long bytes;            // Bytes written to the client
+    unsigned long packets;          // Writes to the client (one packet each)
+    unsigned long writes;           // Print writes collected into those packets
+    unsigned long bySize, byTime, forced;   // Packets by flush reason
+    unsigned long dropped;          // Bytes lost (no client, or a short write)
+
+  private:
+    unsigned int send(void);
+
+    byte buf[DSC_NET_BUFFER];
+    unsigned int len;
+    unsigned int flushSize;
+    unsigned int flushMs;
+    unsigned long first;            // millis() of the oldest buffered byte
+    Client *client;
+};
+
+#endif
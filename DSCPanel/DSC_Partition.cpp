@@ -0,0 +1,118 @@
+#include "Arduino.h"
+#include "DSC_Partition.h"
+#include "DSC_Strings.h"
+
+DSCPartition::DSCPartition(unsigned int debounceMs)
+  {
+    debounce = debounceMs;
+    known = 0;
+    waiting = 0;
+    for (byte i=0;i<PART_SLOTS;i++) {
+      committed[i] = 0;
+      pending[i] = 0;
+      since[i] = 0;
+      changed[i] = 0;
+    }
+  }
+
+void DSCPartition::setDebounce(unsigned int ms)
+  {
+    debounce = ms;
+  }
+
+byte DSCPartition::update(DSC &dsc)
+  {
+    unsigned long now = millis();
+    byte cmd = dsc.dscGlobal.pCmd;
+    for (byte i=0;i<PART_SLOTS;i++) changed[i] = 0;
+    
+    // ----- Fold the current word into the pending state -----
+    if (cmd == 0x05) observe(0, dsc.dscGlobal.pStatus, now);
+    if (cmd == 0xa5 && dsc.dscGlobal.armState)
+      observe(1, (dsc.dscGlobal.armState << 6) | (dsc.dscGlobal.armUser & 0x3f), now);
+    for (byte grp=0;grp<ZONE_GROUPS;grp++)
+      if (cmd == zoneCmd[grp]) observe(2 + grp, dsc.dscGlobal.zones[grp], now);
+    
+    // ----- Commit the changes that outlasted the debounce window -----
+    byte flags = 0;
+    for (byte i=0;i<PART_SLOTS;i++) {
+      if (!(waiting & (1 << i)) || (now - since[i]) < debounce) continue;
+      changed[i] = committed[i] ^ pending[i];
+      if (!(known & (1 << i))) {
+        // First value: report the flags that are set (and ready or not), the
+        // arm info, and the open zones
+        if (i == 0) changed[i] = pending[i] | ST_READY;
+        else if (i == 1) changed[i] = 0xff;
+        else changed[i] = pending[i];
+      }
+      committed[i] = pending[i];
+      known |= (1 << i);
+      waiting &= ~(1 << i);
+      if (i == 0) flags |= PART_STATUS;
+      else if (i == 1) flags |= PART_ARM;
+      else flags |= PART_ZONES;
+    }
+    return flags;
+  }
+
+void DSCPartition::observe(byte slot, byte value, unsigned long now)
+  {
+    if (value != pending[slot] || !(waiting & (1 << slot))) {
+      if ((known & (1 << slot)) && value == committed[slot]) {
+        waiting &= ~(1 << slot);        // Back to the reported value, nothing to do
+        pending[slot] = value;
+        return;
+      }
+      pending[slot] = value;            // A new value, (re)start the window
+      since[slot] = now;
+      waiting |= (1 << slot);
+    }
+  }
+
+void DSCPartition::printChanges(Print &out)
+  {
+    // Status names when set and when cleared are in ST_ flag order in the flash
+    // string table (DSC_Strings.h)
+    for (byte i=0;i<7;i++) {
+      if (!(changed[0] & (1 << i))) continue;
+      out.print(dscStr(STR_PARTITION));
+      out.println(dscStr(((committed[0] & (1 << i)) ? STR_ON_READY : STR_OFF_READY) + i));
+    }
+    if (changed[1]) {
+      out.print(dscStr(STR_PARTITION));
+      out.print(dscStr((armState() == 0x02) ? STR_ON_ARMED : STR_OFF_ARMED));
+      out.print(dscStr(STR_BY_CODE));
+      out.println(armUser());
+    }
+    for (byte grp=0;grp<ZONE_GROUPS;grp++) {
+      for (byte i=0;i<8;i++) {
+        if (!(changed[2 + grp] & (1 << i))) continue;
+        out.print(dscStr(STR_PARTITION));
+        out.print(dscStr(STR_ZONE));
+        out.print((grp * 8) + i + 1);
+        out.println(dscStr((committed[2 + grp] & (1 << i)) ? STR_OPEN : STR_CLOSED));
+      }
+    }
+  }
+
+byte DSCPartition::status(void)
+  {
+    return committed[0];
+  }
+
+byte DSCPartition::armState(void)
+  {
+    return committed[1] >> 6;
+  }
+
+byte DSCPartition::armUser(void)
+  {
+    return committed[1] & 0x3f;
+  }
+
+bool DSCPartition::zoneOpen(byte zone)
+  {
+    if (zone < 1 || zone > ZONE_GROUPS * 8) return false;
+    zone--;
+    return committed[2 + (zone / 8)] & (1 << (zone % 8));
+  }
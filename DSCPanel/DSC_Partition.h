@@ -0,0 +1,72 @@
+/* DSC_Partition.h
+ * Part of DSC Library 
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Folds the repeated status (0x05), arm/user info (0xa5) and zone group words
+ * into a single partition state, and reports only the transitions (ready to not
+ * ready, armed to disarmed, zone opened, etc.). A change must be seen for the 
+ * debounce window before it is reported, so a flapping bit is reported once.
+ *
+ * Usage, every loop:
+ *    dsc.process();
+ *    if (partition.update(dsc)) partition.printChanges(Serial);
+ */
+
+#ifndef DSC_Partition_h
+#define DSC_Partition_h
+#include "DSC.h"
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+// ----- Transition Flags (returned by update()) -----
+const byte PART_STATUS = 0x01;      // A status flag changed (ST_READY, ST_ARMED, etc.)
+const byte PART_ARM    = 0x02;      // Armed/disarmed by a (new) user code
+const byte PART_ZONES  = 0x04;      // A zone opened or closed
+
+// State slots: status, arm, then one per zone group
+const byte PART_SLOTS = 2 + ZONE_GROUPS;
+
+class DSCPartition
+{
+  public:
+    // Class to call to initialize the partition with a debounce window in ms
+    // for example...  DSCPartition partition(1000);
+    DSCPartition(unsigned int debounceMs);
+    
+    // Sets the debounce window in ms (0 reports every change right away)
+    void setDebounce(unsigned int ms);
+    
+    // Call every loop, after DSC.process(). Folds the current word of "dsc" into
+    // the state and commits the changes that outlasted the debounce window
+    // Returns the transition flags (0 if nothing changed)
+    byte update(DSC &dsc);
+    
+    // Prints the last transitions as text lines, for example:
+    //   [Partition] Not Ready   /   [Partition] Zone 3 Open
+    void printChanges(Print &out);
+    
+    // ----- Committed (debounced) state -----
+    byte status(void);              // ST_ flags
+    byte armState(void);            // 0x02 armed, 0x03 disarmed, 0 not known
+    byte armUser(void);             // User code of the last arm/disarm
+    bool zoneOpen(byte zone);       // Zone 1 to (ZONE_GROUPS * 8)
+    
+    // Bits that changed in the last update, per slot (status, arm, zone groups)
+    byte changed[PART_SLOTS];
+    
+  private:
+    void observe(byte slot, byte value, unsigned long now);
+    
+    unsigned int debounce;
+    byte committed[PART_SLOTS];     // Reported values
+    byte pending[PART_SLOTS];       // Last seen values, waiting out the debounce
+    unsigned long since[PART_SLOTS];  // millis() when pending last changed
+    byte known;                     // Bit per slot seen at least once
+    byte waiting;                   // Bit per slot with a pending change
+};
+
+#endif
@@ -0,0 +1,201 @@
+#include "Arduino.h"
+#include "DSC_Publish.h"
+#include "DSC_Strings.h"
+
+DSCPublisher::DSCPublisher(Client &c, const char *prefix, unsigned int bufSize)
+  {
+    client = &c;
+    topicPrefix = prefix;
+    _bufSize = bufSize;
+    buffer = NULL;
+    length = 0;
+    interval = PUB_INTERVAL;
+    firstQueued = 0;
+    lastSent = 0;
+    msgCount = 0, byteCount = 0, writeCount = 0, dropCount = 0;
+    pubStatus = 0, pubArm = 0, pubUser = 0;
+    for (byte i=0;i<ZONE_GROUPS;i++) pubZones[i] = 0;
+    seenGroups = 0;
+    seenStatus = false;
+  }
+
+int DSCPublisher::begin(void)
+  {
+    if (buffer) end();            // begin() again, don't leak the old buffer
+    buffer = (byte*)malloc(_bufSize);
+    if (!buffer) return 0;        // return failure if malloc fails
+    length = 0;
+    return _bufSize;
+  }
+
+int DSCPublisher::end(void)
+  {
+    if (!buffer) return 0;        // return failure
+    flush();
+    free(buffer);
+    buffer = NULL;                // The other functions now do nothing
+    length = 0;
+    return 1;                     // return success
+  }
+
+int DSCPublisher::connect(const char *clientId)
+  {
+    if (!buffer) return 0;        // return failure
+    flush();
+    
+    // CONNECT: protocol "MQTT" level 4, clean session, keep alive, client id
+    unsigned int idLen = strlen(clientId);
+    if (idLen > 100) return 0;    // Keep the remaining length in one byte
+    byte hdr[] = { 0x10, (byte)(12 + idLen), 0, 4, 'M', 'Q', 'T', 'T', 4, 0x02,
+                   (byte)(PUB_KEEPALIVE >> 8), (byte)(PUB_KEEPALIVE & 0xff),
+                   (byte)(idLen >> 8), (byte)(idLen & 0xff) };
+    client->write(hdr, sizeof(hdr));
+    client->write((const uint8_t*)clientId, idLen);
+    byteCount += sizeof(hdr) + idLen;
+    writeCount++;
+    lastSent = millis();
+    
+    // A new session has no retained state from us yet, publish everything again
+    seenGroups = 0;
+    seenStatus = false;
+    pubArm = 0;
+    return 1;
+  }
+
+void DSCPublisher::update(DSC &dsc)
+  {
+    byte cmd = dsc.dscGlobal.pCmd;
+    
+    if (cmd == 0x05) {
+      byte changed = seenStatus ? (dsc.dscGlobal.pStatus ^ pubStatus) : 0x7f;
+      pubStatus = dsc.dscGlobal.pStatus;
+      seenStatus = true;
+      publishStatus(changed);
+    }
+    
+    for (byte grp=0;grp<ZONE_GROUPS;grp++) {
+      if (cmd != zoneCmd[grp]) continue;
+      byte changed = (seenGroups & (1 << grp)) ? (dsc.dscGlobal.zones[grp] ^ pubZones[grp]) : 0xff;
+      pubZones[grp] = dsc.dscGlobal.zones[grp];
+      seenGroups |= (1 << grp);
+      publishZones(grp, changed);
+    }
+    
+    if (cmd == 0xa5 && dsc.dscGlobal.armState && 
+        (dsc.dscGlobal.armState != pubArm || dsc.dscGlobal.armUser != pubUser)) {
+      pubArm = dsc.dscGlobal.armState;
+      pubUser = dsc.dscGlobal.armUser;
+      char payload[14];
+      strcpy(payload, (pubArm == 0x02) ? "armed " : "disarmed ");
+      utoa(pubUser, payload + strlen(payload), 10);
+      publish(F("arm"), -1, payload, true);
+    }
+    
+    if (dsc.dscGlobal.kCmd == fire) publish(F("alarm"), -1, "fire", false);
+    if (dsc.dscGlobal.kCmd == aux) publish(F("alarm"), -1, "aux", false);
+    if (dsc.dscGlobal.kCmd == panic) publish(F("alarm"), -1, "panic", false);
+  }
+
+void DSCPublisher::snapshot(void)
+  {
+    if (seenStatus) publishStatus(0x7f);
+    for (byte grp=0;grp<ZONE_GROUPS;grp++)
+      if (seenGroups & (1 << grp)) publishZones(grp, 0xff);
+  }
+
+void DSCPublisher::publishZones(byte grp, byte changed)
+  {
+    for (byte i=0;i<8;i++) {
+      if (!(changed & (1 << i))) continue;
+      publish(F("zone/"), (grp * 8) + i + 1, (pubZones[grp] & (1 << i)) ? "1" : "0", true);
+    }
+  }
+
+void DSCPublisher::publishStatus(byte changed)
+  {
+    for (byte i=0;i<7;i++) {
+      if (!(changed & (1 << i))) continue;
+      // Status topic names are in the flash string table, in ST_ flag order
+      publish(dscStr(STR_TOPIC_READY + i), -1, (pubStatus & (1 << i)) ? "1" : "0", true);
+    }
+  }
+
+int DSCPublisher::publish(const __FlashStringHelper *topic, int num, const char *payload, bool retain)
+  {
+    if (!buffer) return 0;        // return failure
+    
+    PGM_P name = (PGM_P)topic;
+    unsigned int nameLen = strlen_P(name);
+    char numStr[6] = "";
+    if (num >= 0) utoa(num, numStr, 10);
+    unsigned int prefixLen = strlen(topicPrefix);
+    unsigned int topicLen = prefixLen + 1 + nameLen + strlen(numStr);
+    unsigned int payloadLen = strlen(payload);
+    unsigned int remaining = 2 + topicLen + payloadLen;
+    unsigned int packetLen = 1 + ((remaining > 127) ? 2 : 1) + remaining;
+    
+    if (packetLen > _bufSize) {   // Can never fit, drop it
+      dropCount++;
+      return 0;
+    }
+    if (length + packetLen > _bufSize) flush();   // Make room, send the batch so far
+    if (length == 0) firstQueued = millis();
+    
+    // PUBLISH, QoS 0, no packet id: header, remaining length, topic, payload
+    byte *p = buffer + length;
+    *p++ = retain ? 0x31 : 0x30;
+    if (remaining > 127) {
+      *p++ = (remaining & 0x7f) | 0x80;
+      *p++ = remaining >> 7;
+    }
+    else *p++ = remaining;
+    *p++ = topicLen >> 8;
+    *p++ = topicLen & 0xff;
+    memcpy(p, topicPrefix, prefixLen);      p += prefixLen;
+    *p++ = '/';
+    memcpy_P(p, name, nameLen);             p += nameLen;
+    memcpy(p, numStr, strlen(numStr));      p += strlen(numStr);
+    memcpy(p, payload, payloadLen);         p += payloadLen;
+    
+    length += packetLen;
+    msgCount++;
+    if (interval == 0) flush();
+    return 1;
+  }
+
+void DSCPublisher::loop(void)
+  {
+    if (!buffer) return;
+    
+    // Nothing is read from the broker (QoS 0), just keep the receive buffer empty
+    while (client->available()) client->read();
+    
+    if (length && (millis() - firstQueued) >= interval) flush();
+    
+    if (client->connected() && (millis() - lastSent) > (PUB_KEEPALIVE * 1000UL / 2)) {
+      byte ping[] = { 0xc0, 0x00 };         // PINGREQ
+      client->write(ping, sizeof(ping));
+      byteCount += sizeof(ping);
+      writeCount++;
+      lastSent = millis();
+    }
+  }
+
+int DSCPublisher::flush(void)
+  {
+    if (!buffer || !length) return 0;
+    int n = 0;
+    if (client->connected()) {
+      n = client->write(buffer, length);
+      byteCount += n;
+      writeCount++;
+      lastSent = millis();
+    }
+    length = 0;                   // Messages for a lost connection are dropped
+    return n;
+  }
+
+void DSCPublisher::setInterval(unsigned int ms)
+  {
+    interval = ms;
+  }
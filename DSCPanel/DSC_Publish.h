@@ -0,0 +1,105 @@
+/* DSC_Publish.h
+ * Part of DSC Library 
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Publishes the decoded panel state as MQTT (3.1.1, QoS 0) messages over any
+ * Arduino Client (EthernetClient, WiFiClient, etc.). Messages are packed into a
+ * batch buffer and written in one go when the flush interval has passed or the
+ * buffer is full, so a zone group changing at once costs one network write.
+ *
+ * Topics (with the default "dsc" prefix):
+ *    dsc/zone/<n>     "1" open, "0" closed               (retained)
+ *    dsc/status/<s>   "1" / "0" for ready, armed, memory, 
+ *                     bypass, error, program, power      (retained)
+ *                     "1" when the ST_ flag is set, so power is "1" on
+ *                     a power failure (as "powerFail" in DSC_Json)
+ *    dsc/arm          "armed <user>" / "disarmed <user>" (retained)
+ *    dsc/alarm        "fire", "aux" or "panic" (keypad)
+ *
+ * Usage:
+ *    DSCPublisher pub(client, "dsc", 256);
+ *    pub.begin();  pub.connect("dsc-monitor");     (after client.connect())
+ *    if (dsc.process()) pub.update(dsc);  pub.loop();
+ */
+
+#ifndef DSC_Publish_h
+#define DSC_Publish_h
+#include "DSC.h"
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+#include <Client.h>
+
+const unsigned int PUB_INTERVAL = 250;    // Default flush interval (ms)
+const unsigned int PUB_KEEPALIVE = 60;    // MQTT keep alive (s)
+
+class DSCPublisher
+{
+  public:
+    // Class to call to initialize the publisher (before Setup). Requires the
+    // client used as transport, the topic prefix and the batch buffer size in bytes
+    DSCPublisher(Client &c, const char *prefix, unsigned int bufSize);
+    
+    // Begins the publisher; allocates the batch buffer (in Setup)
+    // Returns the buffer size, or 0 if malloc fails
+    int begin(void);
+    
+    // Ends the publisher; writes out the batch and frees the buffer. Requires
+    // a begin() to publish again. Returns 0 if there was no buffer, 1 if freed
+    int end(void);
+    
+    // Sends the MQTT CONNECT packet, call after the client has connected
+    // Also marks all state as unpublished, so the next updates send a full snapshot
+    int connect(const char *clientId);
+    
+    // Called after a successful DSC.process(), queues messages for whatever
+    // changed in the decoded panel state of "dsc"
+    void update(DSC &dsc);
+    
+    // Re-queues the retained state of every zone group and status seen so far
+    void snapshot(void);
+    
+    // Called every loop, flushes the batch when the flush interval has passed,
+    // sends the keep alive ping and discards data from the broker
+    void loop(void);
+    
+    // Writes out the batch now, returns the number of bytes written
+    int flush(void);
+    
+    // Sets the flush interval in ms (0 flushes every message)
+    void setInterval(unsigned int ms);
+    
+    // ----- Counters -----
+    unsigned long msgCount;       // Messages queued
+    unsigned long byteCount;      // Bytes written to the client
+    unsigned long writeCount;     // Writes (batches) to the client
+    unsigned int dropCount;       // Messages too big for the buffer
+    
+  private:
+    // Queues one PUBLISH packet, the topic is prefix + "/" + topic [+ num], the
+    // topic is a flash string (F() or dscStr()), so topic names take no RAM
+    int publish(const __FlashStringHelper *topic, int num, const char *payload, bool retain);
+    void publishZones(byte grp, byte changed);
+    void publishStatus(byte changed);
+    
+    Client *client;
+    const char *topicPrefix;
+    byte *buffer;
+    unsigned int _bufSize;
+    unsigned int length;          // Bytes queued in the buffer
+    unsigned int interval;
+    unsigned long firstQueued;    // millis() when the batch was started
+    unsigned long lastSent;       // millis() of the last write (for the keep alive)
+    
+    // Last published state
+    byte pubStatus;
+    byte pubZones[ZONE_GROUPS];
+    byte pubArm, pubUser;
+    byte seenGroups;              // Bit per zone group published at least once
+    bool seenStatus;
+};
+
+#endif
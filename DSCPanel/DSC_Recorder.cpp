@@ -0,0 +1,134 @@
+#include "Arduino.h"
+#include "DSC_Recorder.h"
+
+DSCRecorder::DSCRecorder(unsigned int bufSize)
+  {
+    out = NULL;
+    _bufSize = bufSize;
+    buf[0] = NULL, buf[1] = NULL;
+    len[0] = 0, len[1] = 0;
+    full[0] = false, full[1] = false;
+    active = 0;
+    running = false;
+    overrun = false;
+    lastEdge = 0;
+    edges = 0, lost = 0, byteCount = 0;
+  }
+
+int DSCRecorder::begin(void)
+  {
+    if (_bufSize < 2 * REC_MAX_VARINT) return 0;   // return failure, too small to hold edges
+    buf[0] = (byte*)malloc(_bufSize);
+    buf[1] = (byte*)malloc(_bufSize);
+    if (!buf[0] || !buf[1]) {
+      free(buf[0]), free(buf[1]);
+      buf[0] = NULL, buf[1] = NULL;
+      return 0;                   // return failure if malloc fails
+    }
+    return _bufSize;
+  }
+
+int DSCRecorder::start(Print &o)
+  {
+    if (!buf[0]) return 0;        // return failure
+    stop();
+    out = &o;
+
+    noInterrupts();
+    len[0] = 0, len[1] = 0;
+    full[0] = false, full[1] = false;
+    active = 0;
+    overrun = false;
+    edges = 0, lost = 0;
+    lastEdge = micros();
+    running = true;
+    interrupts();
+
+    out->write((const uint8_t*)"DSCR", 4);
+    out->write(REC_VERSION);
+    byteCount = 5;
+    return 1;
+  }
+
+void DSCRecorder::stop(void)
+  {
+    running = false;
+  }
+
+int DSCRecorder::recording(void)
+  {
+    return running ? 1 : 0;
+  }
+
+void DSCRecorder::edge(unsigned long t, byte clk, byte dta)
+  {
+    if (!running) return;
+
+    // Switch halves when the active one can't hold another edge and the marker
+    byte h = active;
+    if (len[h] > _bufSize - 2 * REC_MAX_VARINT) {
+      if (full[h ^ 1]) {          // Both halves are waiting for flush(), drop the edge
+        lost++;
+        overrun = true;
+        lastEdge = t;
+        return;
+      }
+      full[h] = true;
+      h ^= 1;
+      active = h;
+    }
+
+    byte *b = buf[h];
+    unsigned int n = len[h];
+    if (overrun) {
+      b[n++] = 0x80;
+      b[n++] = 0x00;
+      overrun = false;
+    }
+
+    unsigned long delta = t - lastEdge;
+    if (delta > REC_MAX_DELTA) delta = REC_MAX_DELTA;
+    lastEdge = t;
+    unsigned long v = (delta << 2) | ((clk ? 1 : 0) << 1) | (dta ? 1 : 0);
+    while (v > 0x7f) {
+      b[n++] = (v & 0x7f) | 0x80;
+      v >>= 7;
+    }
+    b[n++] = v;
+    len[h] = n;
+    edges++;
+  }
+
+int DSCRecorder::flush(bool all)
+  {
+    if (!out) return 0;
+    int count = 0;
+
+    // The full halves aren't touched by the ISR until they are emptied here
+    byte h = active ^ 1;
+    if (full[h]) count += writeHalf(h);
+
+    if (all) {
+      // Hand the ISR the (now empty) other half and write the one it was filling
+      noInterrupts();
+      h = active;
+      bool swap = (len[h] > 0 && !full[h ^ 1]);
+      if (swap) {
+        full[h] = true;
+        active = h ^ 1;
+      }
+      interrupts();
+      if (swap) count += writeHalf(h);
+    }
+    return count;
+  }
+
+int DSCRecorder::writeHalf(byte h)
+  {
+    unsigned int n = len[h];
+    out->write(buf[h], n);
+    byteCount += n;
+    len[h] = 0;
+    full[h] = false;              // Last, the ISR may switch to this half from here on
+    return n;
+  }
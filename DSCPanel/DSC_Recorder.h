@@ -0,0 +1,90 @@
+/* DSC_Recorder.h
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Raw keybus capture recorder. The ISR hands it every clock edge (time, clock
+ * level and data line level) and it packs them into the active half of a double
+ * buffer; flush(), called from the main loop, writes the filled half to any Print
+ * (Serial, an SD File, a Client) while the ISR keeps filling the other half.
+ *
+ * Capture format (read by dscrecord.py, which converts it to VCD and rebuilds
+ * the panel/keypad words):
+ *    Header:   "DSCR" + REC_VERSION (1 byte)
+ *    Edges:    one unsigned LEB128 varint per edge, (delta_us << 2) | (clk << 1) | data
+ *              where delta_us is the time since the previous edge (or since start())
+ *    Overrun:  the bytes 0x80 0x00 (a non-minimal zero, never written for an edge),
+ *              edges were lost because both halves were full, the next delta is
+ *              measured from the last lost edge
+ *
+ * The normal edges take 2 bytes (about 4 kB/s on a busy bus), 115200 baud Serial
+ * keeps up with it if nothing else is printed to it.
+ *
+ * Usage:
+ *    DSCRecorder rec(128);
+ *    rec.begin();  rec.start(Serial);  dsc.setRecorder(&rec);    (in setup())
+ *    rec.flush();                                                 (in loop())
+ */
+
+#ifndef DSC_Recorder_h
+#define DSC_Recorder_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+const byte REC_VERSION = 1;
+const byte REC_MAX_VARINT = 5;              // Bytes of the largest edge varint
+const unsigned long REC_MAX_DELTA = 0x3fffffffUL;  // Longer deltas are clipped
+
+class DSCRecorder
+{
+  public:
+    // Class to call to initialize the recorder, "bufSize" is the size of each
+    // half of the double buffer (2 * bufSize bytes are allocated by begin())
+    // for example...  DSCRecorder rec(128);
+    DSCRecorder(unsigned int bufSize);
+
+    // Allocates the buffers
+    // Returns:   the buffer size, or 0 if malloc fails
+    int begin(void);
+
+    // Writes the capture header to "out" and starts recording the edges
+    // Returns:   1 for success, 0 if begin() failed
+    int start(Print &out);
+
+    // Stops recording, the edges still buffered are written by flush(true)
+    void stop(void);
+
+    // Called from the ISR for every clock edge, must stay short
+    void edge(unsigned long t, byte clk, byte dta);
+
+    // Writes the filled buffer half to the output, with "all" also the edges
+    // of the half being filled (at the end of a recording)
+    // Returns:   the number of bytes written
+    int flush(bool all = false);
+
+    // Returns 1 while recording, 0 if not
+    int recording(void);
+
+    // ----- Statistics since start() -----
+    unsigned long edges;                // Edges recorded
+    unsigned long lost;                 // Edges lost to overruns
+    unsigned long byteCount;            // Bytes written to the output
+
+  private:
+    Print *out;
+    unsigned int _bufSize;
+    byte *buf[2];                       // The two halves
+    volatile unsigned int len[2];       // Bytes used in each half
+    volatile bool full[2];              // Half waiting for flush()
+    volatile byte active;               // Half the ISR is filling
+    volatile bool running;
+    volatile bool overrun;              // Overrun marker is pending
+    unsigned long lastEdge;             // Time of the previous edge (us)
+
+    int writeHalf(byte h);
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include "Arduino.h"
+#include "DSC_Scheduler.h"
+
+DSCScheduler::DSCScheduler(void)
+  {
+    memset(tasks, 0, sizeof(tasks));
+    count = 0;
+    reportFn = NULL;
+    passes = 0;
+    maxPass = 0;
+  }
+
+byte DSCScheduler::add(const __FlashStringHelper *name, void (*fn)(void), unsigned long period,
+                       byte priority)
+  {
+    return addTask(name, fn, period, 0, priority, TASK_USED);
+  }
+
+byte DSCScheduler::once(const __FlashStringHelper *name, void (*fn)(void), unsigned long delay,
+                        byte priority)
+  {
+    return addTask(name, fn, 0, delay, priority, TASK_USED | TASK_ONESHOT);
+  }
+
+byte DSCScheduler::addTask(const __FlashStringHelper *name, void (*fn)(void), unsigned long period,
+                           unsigned long delay, byte priority, byte flags)
+  {
+    if (!fn) return SCHED_NONE;
+    byte i = 0;
+    while (i < SCHED_MAX_TASKS && (tasks[i].flags & TASK_USED)) i++;
+    if (i == SCHED_MAX_TASKS) return SCHED_NONE;    // return failure (all slots used)
+
+    dscTask_t &t = tasks[i];
+    memset(&t, 0, sizeof(dscTask_t));
+    t.name = name;
+    t.fn = fn;
+    t.period = period;
+    t.due = millis() + delay;
+    t.priority = (priority > SCHED_PRI_LOW) ? SCHED_PRI_LOW : priority;
+    t.flags = flags;
+
+    // Insert after the tasks of the same or a higher priority
+    byte pos = count;
+    while (pos > 0 && tasks[order[pos - 1]].priority > t.priority) {
+      order[pos] = order[pos - 1];
+      pos--;
+    }
+    order[pos] = i;
+    count++;
+    return i;
+  }
+
+int DSCScheduler::setLimits(byte task, unsigned long budget, unsigned long deadline)
+  {
+    if (task >= SCHED_MAX_TASKS || !(tasks[task].flags & TASK_USED)) return 0;
+    tasks[task].budget = budget;
+    tasks[task].deadline = deadline;
+    return 1;
+  }
+
+int DSCScheduler::remove(byte task)
+  {
+    if (task >= SCHED_MAX_TASKS || !(tasks[task].flags & TASK_USED)) return 0;
+    tasks[task].flags = 0;
+    byte j = 0;
+    for (byte k=0;k<count;k++)
+      if (order[k] != task) order[j++] = order[k];
+    count = j;
+    return 1;
+  }
+
+int DSCScheduler::pause(byte task, bool paused)
+  {
+    if (task >= SCHED_MAX_TASKS || !(tasks[task].flags & TASK_USED)) return 0;
+    if (paused) tasks[task].flags |= TASK_PAUSED;
+    else if (tasks[task].flags & TASK_PAUSED) {
+      tasks[task].flags &= ~TASK_PAUSED;
+      tasks[task].due = millis();
+    }
+    return 1;
+  }
+
+void DSCScheduler::onReport(void (*fn)(byte task, const dscTask_t &t, byte reason))
+  {
+    reportFn = fn;
+  }
+
+const dscTask_t *DSCScheduler::task(byte task)
+  {
+    if (task >= SCHED_MAX_TASKS) return NULL;
+    return &tasks[task];
+  }
+
+bool DSCScheduler::isDue(byte i, unsigned long now)
+  {
+    if ((tasks[i].flags & (TASK_USED | TASK_PAUSED)) != TASK_USED) return false;
+    return (long)(now - tasks[i].due) >= 0;         // Safe across the millis() wrap
+  }
+
+void DSCScheduler::runTask(byte i, unsigned long now)
+  {
+    dscTask_t &t = tasks[i];
+    unsigned long late = now - t.due;
+    unsigned long start = micros();
+    t.fn();
+    unsigned long took = micros() - start;
+
+    t.runs++;
+    t.lastRun = took;
+    if (took > t.maxRun) t.maxRun = took;
+    t.totalRun += took;
+    if (late > t.maxLate) t.maxLate = late;
+
+    if (t.budget && took > t.budget) {
+      if (t.overBudget < 0xffff) t.overBudget++;
+      if (reportFn) reportFn(i, t, SCHED_OVER_BUDGET);
+    }
+    if (t.deadline && late > t.deadline) {
+      if (t.missed < 0xffff) t.missed++;
+      if (reportFn) reportFn(i, t, SCHED_LATE);
+    }
+
+    if (t.flags & TASK_ONESHOT) {
+      remove(i);
+      return;
+    }
+    // Next run one period after the last due time, a task that fell a whole
+    // period behind starts over from now instead of running back to back
+    t.due += t.period;
+    if ((long)(now - t.due) >= 0) t.due = now + t.period;
+  }
+
+byte DSCScheduler::runTop(void)
+  {
+    byte ran = 0;
+    for (byte k=0;k<count && tasks[order[k]].priority == SCHED_PRI_TOP;k++) {
+      byte i = order[k];
+      unsigned long now = millis();
+      if (!isDue(i, now)) continue;
+      runTask(i, now);
+      ran++;
+      if (k < count && order[k] != i) k--;          // A one-shot removed itself
+    }
+    return ran;
+  }
+
+byte DSCScheduler::run(void)
+  {
+    unsigned long start = micros();
+    passes++;
+    byte ran = runTop();
+
+    // The task list can change while the tasks run (one-shots, add/remove in a
+    // task), so the pass works on a copy of the order
+    byte list[SCHED_MAX_TASKS];
+    byte n = count;
+    memcpy(list, order, n);
+    bool first = true;
+    for (byte k=0;k<n;k++) {
+      byte i = list[k];
+      if (tasks[i].priority == SCHED_PRI_TOP) continue;
+      if (!isDue(i, millis())) continue;
+      if (!first) ran += runTop();                  // Decoding goes between tasks
+      if (!isDue(i, millis())) continue;            // Removed/paused by a top task
+      runTask(i, millis());
+      ran++;
+      first = false;
+    }
+
+    unsigned long took = micros() - start;
+    if (took > maxPass) maxPass = took;
+    return ran;
+  }
+
+void DSCScheduler::printReport(Print &out)
+  {
+    out.println(F("Task        Runs  Last(us)  Max(us)  Avg(us)  Late(ms)  Over  Missed"));
+    for (byte k=0;k<count;k++) {
+      const dscTask_t &t = tasks[order[k]];
+      byte len = 0;
+      if (t.name) len = out.print(t.name);
+      for (;len<10;len++) out.print(' ');
+      out.print(' ');
+      out.print(t.runs);
+      out.print(F("  "));
+      out.print(t.lastRun);
+      out.print(F("  "));
+      out.print(t.maxRun);
+      out.print(F("  "));
+      out.print(t.runs ? t.totalRun / t.runs : 0);
+      out.print(F("  "));
+      out.print(t.maxLate);
+      out.print(F("  "));
+      out.print(t.overBudget);
+      out.print(F("  "));
+      out.print(t.missed);
+      if (t.flags & TASK_PAUSED) out.print(F("  (paused)"));
+      out.println();
+    }
+    out.print(F("Passes: "));
+    out.print(passes);
+    out.print(F(", longest pass (us): "));
+    out.println(maxPass);
+  }
+
+void DSCScheduler::resetStats(void)
+  {
+    for (byte i=0;i<SCHED_MAX_TASKS;i++) {
+      dscTask_t &t = tasks[i];
+      t.runs = t.lastRun = t.maxRun = t.totalRun = t.maxLate = 0;
+      t.overBudget = t.missed = 0;
+    }
+    passes = 0;
+    maxPass = 0;
+  }
@@ -0,0 +1,134 @@
+/* DSC_Scheduler.h
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Cooperative task scheduler for the sketch main loop. Tasks are plain functions
+ * run from run() when they are due, periodic (every "period" ms, 0 for every
+ * pass) or one-shot (once, "delay" ms from now). Nothing is preempted, so every
+ * task has to return quickly; the scheduler measures how long each one runs and
+ * how late it started, and calls the report hook when a task goes over its
+ * runtime budget or misses its deadline, so a slow task can be found.
+ *
+ * Each pass of run() runs every due task once, lowest priority number first.
+ * The SCHED_PRI_TOP tasks (the DSC decode task) also run again before each of
+ * the other tasks, so decoding never waits for more than one task.
+ *
+ * Memory use is fixed (SCHED_MAX_TASKS slots), nothing is allocated.
+ *
+ * Usage:
+ *    DSCScheduler sched;
+ *    sched.add(F("decode"), decodeTask, 0, SCHED_PRI_TOP);      (in setup())
+ *    byte t = sched.add(F("watchdog"), watchdogTask, 1000, 3);
+ *    sched.setLimits(t, 2000, 100);       (2 ms budget, may start 100 ms late)
+ *    sched.run();                                               (in loop())
+ */
+
+#ifndef DSC_Scheduler_h
+#define DSC_Scheduler_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+const byte SCHED_MAX_TASKS = 8;
+const byte SCHED_NONE = 0xff;           // Returned by add()/once() when full
+
+// ----- Priorities (lower runs first) -----
+const byte SCHED_PRI_TOP = 0;           // Runs before every other task (decoding)
+const byte SCHED_PRI_LOW = 7;
+
+// ----- Task Flags -----
+const byte TASK_USED    = 0x01;
+const byte TASK_ONESHOT = 0x02;
+const byte TASK_PAUSED  = 0x04;
+
+// ----- Report Reasons (passed to the report hook) -----
+const byte SCHED_OVER_BUDGET = 1;       // The task ran longer than its budget
+const byte SCHED_LATE        = 2;       // The task started after its deadline
+
+typedef struct
+{
+  const __FlashStringHelper *name;
+  void (*fn)(void);
+  unsigned long period;           // ms between runs, 0 for every pass
+  unsigned long due;              // millis() of the next run
+  unsigned long budget;           // Longest allowed runtime (us), 0 for none
+  unsigned long deadline;         // Longest allowed start delay (ms), 0 for none
+  byte priority;
+  byte flags;                     // TASK_ flags
+
+  // ----- Accounting (since add() or resetStats()) -----
+  unsigned long runs;
+  unsigned long lastRun;          // Runtime of the last run (us)
+  unsigned long maxRun;           // Longest runtime (us)
+  unsigned long totalRun;         // Sum of the runtimes (us, wraps after 71 min busy)
+  unsigned long maxLate;          // Longest start delay past "due" (ms), for the
+                                  // every pass tasks the longest time between runs
+  unsigned int overBudget;        // Runs over the budget (saturating)
+  unsigned int missed;            // Runs started after the deadline (saturating)
+}
+dscTask_t;
+
+class DSCScheduler
+{
+  public:
+    // Class to call to initialize the scheduler
+    // for example...  DSCScheduler sched;
+    DSCScheduler(void);
+
+    // Adds a periodic task, first run on the next pass
+    // Returns:   the task number, SCHED_NONE if all slots are used
+    byte add(const __FlashStringHelper *name, void (*fn)(void), unsigned long period,
+             byte priority);
+
+    // Adds a one-shot task, run once "delay" ms from now, then removed
+    // Returns:   the task number, SCHED_NONE if all slots are used
+    byte once(const __FlashStringHelper *name, void (*fn)(void), unsigned long delay,
+              byte priority);
+
+    // Sets the runtime budget (us) and start deadline (ms) of a task, 0 for none
+    // Returns:   1 for success, 0 if there is no such task
+    int setLimits(byte task, unsigned long budget, unsigned long deadline);
+
+    // Removes a task, or pauses/resumes it (a resumed task runs on the next pass)
+    // Returns:   1 for success, 0 if there is no such task
+    int remove(byte task);
+    int pause(byte task, bool paused);
+
+    // Called every loop, runs the due tasks
+    // Returns:   the number of tasks run
+    byte run(void);
+
+    // Registers the function called after a task ran over its budget or started
+    // after its deadline (SCHED_OVER_BUDGET / SCHED_LATE), NULL for none
+    void onReport(void (*fn)(byte task, const dscTask_t &t, byte reason));
+
+    // Returns the task in slot "task" (check t.flags & TASK_USED), NULL if out of range
+    const dscTask_t *task(byte task);
+
+    // Prints one line per task: name, runs, last/max/average runtime (us),
+    // longest start delay (ms), budget overruns and missed deadlines
+    void printReport(Print &out);
+
+    // Clears the accounting of all tasks
+    void resetStats(void);
+
+    unsigned long passes;           // Calls to run()
+    unsigned long maxPass;          // Longest run() (us)
+
+  private:
+    byte addTask(const __FlashStringHelper *name, void (*fn)(void), unsigned long period,
+                 unsigned long delay, byte priority, byte flags);
+    void runTask(byte i, unsigned long now);
+    bool isDue(byte i, unsigned long now);
+    byte runTop(void);
+
+    dscTask_t tasks[SCHED_MAX_TASKS];
+    byte order[SCHED_MAX_TASKS];    // Used slots by priority, then by add order
+    byte count;                     // Entries in order[]
+    void (*reportFn)(byte task, const dscTask_t &t, byte reason);
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "Arduino.h"
+#include "DSC_Strings.h"
+
+// ----- Strings -----
+static const char sStatus[]        PROGMEM = "[Status] ";
+static const char sReady[]         PROGMEM = "Ready";
+static const char sNotReady[]      PROGMEM = "Not Ready";
+static const char sCError[]        PROGMEM = ", Error";
+static const char sCBypass[]       PROGMEM = ", Bypass";
+static const char sCMemory[]       PROGMEM = ", Memory";
+static const char sCArmed[]        PROGMEM = ", Armed";
+static const char sCProgram[]      PROGMEM = ", Program";
+static const char sCPowerFail[]    PROGMEM = ", Power Fail";
+static const char sInfo[]          PROGMEM = "[Info] ";
+static const char sCDisarmed[]     PROGMEM = ", Disarmed";
+static const char sCMasterCode[]   PROGMEM = ", Master Code";
+static const char sCUserCode[]     PROGMEM = ", User Code";
+static const char sZones[]         PROGMEM = "[Zones ";
+static const char sZonesEnd[]      PROGMEM = "] ";
+static const char sZonesReady[]    PROGMEM = "Ready ";
+static const char sKeypadQuery[]   PROGMEM = "[Keypad Query] ";
+static const char sProgramMode[]   PROGMEM = "[Panel Program Mode] ";
+static const char sAlarmMem1[]     PROGMEM = "[Alarm Memory Group 1] ";
+static const char sAlarmMem2[]     PROGMEM = "[Alarm Memory Group 2] ";
+static const char sBeep1[]         PROGMEM = "[Beep Command Group 1] ";
+static const char sBeep2[]         PROGMEM = "[Beep Command Group 2] ";
+static const char sUndefined[]     PROGMEM = "[Undefined command from panel] ";
+static const char sZoneConfig[]    PROGMEM = "[Zone Configuration] ";
+static const char sCBeeps[]        PROGMEM = " Beeps";
+static const char sCConstantTone[] PROGMEM = ", Constant Tone";
+static const char sCInterval[]     PROGMEM = ", Interval ";
+static const char sSeconds[]       PROGMEM = "s";
+static const char sCMode[]         PROGMEM = ", Mode 0x";
+static const char sButton[]        PROGMEM = "[Button] ";
+static const char sKey1[]          PROGMEM = "1";
+static const char sKey2[]          PROGMEM = "2";
+static const char sKey3[]          PROGMEM = "3";
+static const char sKey4[]          PROGMEM = "4";
+static const char sKey5[]          PROGMEM = "5";
+static const char sKey6[]          PROGMEM = "6";
+static const char sKey7[]          PROGMEM = "7";
+static const char sKey8[]          PROGMEM = "8";
+static const char sKey9[]          PROGMEM = "9";
+static const char sKeyAster[]      PROGMEM = "*";
+static const char sKey0[]          PROGMEM = "0";
+static const char sKeyPound[]      PROGMEM = "#";
+static const char sKeyStay[]       PROGMEM = "Stay";
+static const char sKeyAway[]       PROGMEM = "Away";
+static const char sKeyChime[]      PROGMEM = "Chime";
+static const char sKeyReset[]      PROGMEM = "Reset";
+static const char sKeyExit[]       PROGMEM = "Exit";
+static const char sKeyLeft[]       PROGMEM = "<";
+static const char sKeyRight[]      PROGMEM = ">";
+static const char sKeyFire[]       PROGMEM = "Fire";
+static const char sKeyAux[]        PROGMEM = "Auxillary";
+static const char sKeyPanic[]      PROGMEM = "Panic";
+static const char sKeypadResponse[] PROGMEM = "[Keypad Response]";
+static const char sKeypadHex[]     PROGMEM = "[Keypad] 0x";
+static const char sUnknown[]       PROGMEM = " (Unknown)";
+static const char sKeypadSlots[]   PROGMEM = "[Keypad Slots] ";
+static const char sPanelTag[]      PROGMEM = "[Panel]  ";
+static const char sKeypadTag[]     PROGMEM = "[Keypad] ";
+static const char sChecksumOk[]    PROGMEM = " (OK)";
+static const char sPartition[]     PROGMEM = "[Partition] ";
+static const char sOnReady[]       PROGMEM = "Ready";
+static const char sOnArmed[]       PROGMEM = "Armed";
+static const char sOnMemory[]      PROGMEM = "Memory";
+static const char sOnBypass[]      PROGMEM = "Bypass";
+static const char sOnError[]       PROGMEM = "Error";
+static const char sOnProgram[]     PROGMEM = "Program";
+static const char sOnPowerFail[]   PROGMEM = "Power Fail";
+static const char sOffReady[]      PROGMEM = "Not Ready";
+static const char sOffArmed[]      PROGMEM = "Disarmed";
+static const char sOffMemory[]     PROGMEM = "Memory Cleared";
+static const char sOffBypass[]     PROGMEM = "Bypass Off";
+static const char sOffError[]      PROGMEM = "Error Cleared";
+static const char sOffProgram[]    PROGMEM = "Program Off";
+static const char sOffPowerFail[]  PROGMEM = "Power Restored";
+static const char sByCode[]        PROGMEM = " by Code ";
+static const char sZone[]          PROGMEM = "Zone ";
+static const char sOpen[]          PROGMEM = " Open";
+static const char sClosed[]        PROGMEM = " Closed";
+static const char sTopicReady[]    PROGMEM = "status/ready";
+static const char sTopicArmed[]    PROGMEM = "status/armed";
+static const char sTopicMemory[]   PROGMEM = "status/memory";
+static const char sTopicBypass[]   PROGMEM = "status/bypass";
+static const char sTopicError[]    PROGMEM = "status/error";
+static const char sTopicProgram[]  PROGMEM = "status/program";
+static const char sTopicPower[]    PROGMEM = "status/power";
+
+// ----- String Table (in STR_ index order) -----
+const char * const dscStrings[STR_COUNT] PROGMEM = 
+  {
+    sStatus, sReady, sNotReady, sCError, sCBypass, sCMemory, sCArmed, sCProgram,
+    sCPowerFail, sInfo, sCDisarmed, sCMasterCode, sCUserCode, sZones, sZonesEnd,
+    sZonesReady, sKeypadQuery, sProgramMode, sAlarmMem1, sAlarmMem2, sBeep1, sBeep2,
+    sUndefined, sZoneConfig, sCBeeps, sCConstantTone, sCInterval, sSeconds, sCMode,
+    sButton, sKey1, sKey2, sKey3, sKey4, sKey5, sKey6, sKey7, sKey8, sKey9,
+    sKeyAster, sKey0, sKeyPound, sKeyStay, sKeyAway, sKeyChime, sKeyReset, sKeyExit,
+    sKeyLeft, sKeyRight, sKeyFire, sKeyAux, sKeyPanic, sKeypadResponse, sKeypadHex,
+    sUnknown, sKeypadSlots, sPanelTag, sKeypadTag, sChecksumOk, sPartition, sOnReady, sOnArmed,
+    sOnMemory, sOnBypass, sOnError, sOnProgram, sOnPowerFail, sOffReady, sOffArmed,
+    sOffMemory, sOffBypass, sOffError, sOffProgram, sOffPowerFail, sByCode, sZone,
+    sOpen, sClosed, sTopicReady, sTopicArmed, sTopicMemory, sTopicBypass,
+    sTopicError, sTopicProgram, sTopicPower
+  };
@@ -0,0 +1,71 @@
+/* DSC_Strings.h
+ * Part of DSC Library 
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * All user-facing strings of the decoder, kept in one flash (PROGMEM) table
+ * and referenced by index, so none of them take up RAM on AVR boards.
+ * Use dscStr(STR_xxx) wherever a F("...") string could be used.
+ *
+ * In general, applications would not include this file. 
+ */
+
+#ifndef DSC_Strings_h
+#define DSC_Strings_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#endif
+#ifndef pgm_read_ptr
+#define pgm_read_ptr(addr) ((void *)pgm_read_word(addr))
+#endif
+
+// ----- String Indexes (order must match dscStrings[] in DSC_Strings.cpp) -----
+enum {
+  // Panel status [0x05] and flags
+  STR_STATUS, STR_READY, STR_NOT_READY, STR_C_ERROR, STR_C_BYPASS, STR_C_MEMORY,
+  STR_C_ARMED, STR_C_PROGRAM, STR_C_POWER_FAIL,
+  // Panel info [0xa5]
+  STR_INFO, STR_C_DISARMED, STR_C_MASTER_CODE, STR_C_USER_CODE,
+  // Zone groups
+  STR_ZONES, STR_ZONES_END, STR_ZONES_READY,
+  // Other panel commands
+  STR_KEYPAD_QUERY, STR_PROGRAM_MODE, STR_ALARM_MEM_1, STR_ALARM_MEM_2,
+  STR_BEEP_1, STR_BEEP_2, STR_UNDEFINED, STR_ZONE_CONFIG,
+  STR_C_BEEPS, STR_C_CONSTANT_TONE, STR_C_INTERVAL, STR_SECONDS, STR_C_MODE,
+  // Keypad buttons, in KEY_ index order (DSC_Core.h)
+  STR_BUTTON, STR_KEY_1, STR_KEY_2, STR_KEY_3, STR_KEY_4, STR_KEY_5, STR_KEY_6,
+  STR_KEY_7, STR_KEY_8, STR_KEY_9, STR_KEY_ASTER, STR_KEY_0, STR_KEY_POUND,
+  STR_KEY_STAY, STR_KEY_AWAY, STR_KEY_CHIME, STR_KEY_RESET, STR_KEY_EXIT,
+  STR_KEY_LEFT, STR_KEY_RIGHT,
+  STR_KEY_FIRE, STR_KEY_AUX, STR_KEY_PANIC,
+  // Other keypad words
+  STR_KEYPAD_RESPONSE, STR_KEYPAD_HEX, STR_UNKNOWN, STR_KEYPAD_SLOTS,
+  // Formatted words
+  STR_PANEL_TAG, STR_KEYPAD_TAG, STR_CHECKSUM_OK,
+  // Partition transitions (DSC_Partition), set and cleared names in ST_ flag order
+  STR_PARTITION, STR_ON_READY, STR_ON_ARMED, STR_ON_MEMORY, STR_ON_BYPASS,
+  STR_ON_ERROR, STR_ON_PROGRAM, STR_ON_POWER_FAIL,
+  STR_OFF_READY, STR_OFF_ARMED, STR_OFF_MEMORY, STR_OFF_BYPASS,
+  STR_OFF_ERROR, STR_OFF_PROGRAM, STR_OFF_POWER_FAIL,
+  STR_BY_CODE, STR_ZONE, STR_OPEN, STR_CLOSED,
+  // MQTT status topics (DSC_Publish), in ST_ flag order
+  STR_TOPIC_READY, STR_TOPIC_ARMED, STR_TOPIC_MEMORY, STR_TOPIC_BYPASS,
+  STR_TOPIC_ERROR, STR_TOPIC_PROGRAM, STR_TOPIC_POWER,
+  STR_COUNT
+};
+
+extern const char * const dscStrings[STR_COUNT] PROGMEM;
+
+// Returns the string at "index" as a flash string (for print() and String +=)
+inline const __FlashStringHelper *dscStr(byte index)
+  {
+    return (const __FlashStringHelper *)pgm_read_ptr(&dscStrings[index]);
+  }
+
+#endif
@@ -0,0 +1,88 @@
+#include "Arduino.h"
+#include "DSC_Sync.h"
+
+DSCSync::DSCSync(void)
+  {
+    memset(state, 0, sizeof(state));
+    len = 0;
+    seq = 0;
+    lastFrame = millis();
+    deltas = heartbeats = snapshots = 0;
+    bytes = 0;
+  }
+
+byte DSCSync::encode(byte *out, byte type, const byte *payload, byte n)
+  {
+    out[0] = type;
+    out[1] = n;
+    out[2] = seq >> 8;
+    out[3] = seq & 0xff;
+    if (n) memcpy(out + SYNC_HEAD, payload, n);
+    byte check = 0;
+    for (byte i=0;i<SYNC_HEAD + n;i++) check ^= out[i];
+    out[SYNC_HEAD + n] = check;
+    bytes += SYNC_HEAD + n + 1;
+    return SYNC_HEAD + n + 1;
+  }
+
+byte DSCSync::update(DSC &dsc)
+  {
+    byte now[SYNC_FIELDS];
+    now[SYNC_STATUS] = dsc.dscGlobal.pStatus;
+    now[SYNC_ARM] = dsc.dscGlobal.armState;
+    now[SYNC_USER] = dsc.dscGlobal.armUser;
+    for (byte i=0;i<ZONE_GROUPS;i++) now[SYNC_ZONES + i] = dsc.dscGlobal.zones[i];
+
+    // Only the fields with changed bits, as (index, XOR mask) pairs
+    byte pairs[SYNC_FIELDS * 2];
+    byte n = 0;
+    for (byte i=0;i<SYNC_FIELDS;i++) {
+      byte diff = now[i] ^ state[i];
+      if (!diff) continue;
+      pairs[n++] = i;
+      pairs[n++] = diff;
+      state[i] = now[i];
+    }
+
+    if (n) {
+      seq++;
+      deltas++;
+      len = encode(buf, SYNC_DELTA, pairs, n);
+    }
+    else if ((millis() - lastFrame) >= SYNC_HEARTBEAT_MS) {
+      heartbeats++;
+      len = encode(buf, SYNC_HEARTBEAT, NULL, 0);
+    }
+    else return 0;                  // return failure (nothing to send)
+    lastFrame = millis();
+    return len;
+  }
+
+int DSCSync::sendFrame(Print &out)
+  {
+    if (!len) return 0;             // return failure (no frame yet)
+    return out.write(buf, len) == len;
+  }
+
+int DSCSync::snapshot(Print &out)
+  {
+    byte snap[SYNC_MAX_FRAME];
+    byte n = encode(snap, SYNC_SNAPSHOT, state, SYNC_FIELDS);
+    snapshots++;
+    return out.write(snap, n) == n;
+  }
+
+const byte *DSCSync::frame(void)
+  {
+    return buf;
+  }
+
+byte DSCSync::frameLen(void)
+  {
+    return len;
+  }
+
+unsigned int DSCSync::sequence(void)
+  {
+    return seq;
+  }
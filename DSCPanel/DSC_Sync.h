@@ -0,0 +1,100 @@
+/* DSC_Sync.h
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Compact state sync for remote monitors. A client gets a snapshot of the panel
+ * state when it connects (status flags, arm state, last arm user and the zone
+ * groups), then only the bits that changed, as deltas with a sequence number.
+ * A delta is a few bytes where a /STREAM text line is 50 or more, and it is
+ * encoded once by update() and the same bytes are written to every client.
+ *
+ * Frames (binary):
+ *    type    1 byte    'S' snapshot, 'D' delta, 'H' heartbeat
+ *    len     1 byte    payload length
+ *    seq     2 bytes   sequence number, high byte first (wraps at 65535)
+ *    payload len bytes S: the SYNC_FIELDS state bytes, in field order (below)
+ *                      D: pairs of (field index, XOR mask of the changed bits)
+ *                      H: none, repeats the last sequence number when idle
+ *    check   1 byte    XOR of all the bytes before it
+ *
+ * A snapshot carries the current sequence number and every delta after it adds
+ * one, so a client that sees a sequence other than its last + 1 (or a heartbeat
+ * with a different one, or a bad check byte) has lost a frame; it sends
+ * SYNC_RESYNC ('R') and the sketch answers with a new snapshot().
+ *
+ * Usage:
+ *    DSCSync stateSync;
+ *    stateSync.snapshot(client);                           (on connect, or 'R')
+ *    if (stateSync.update(dsc)) stateSync.sendFrame(client);   (every loop)
+ */
+
+#ifndef DSC_Sync_h
+#define DSC_Sync_h
+#include "DSC.h"
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+// ----- State Fields (index in the snapshot/delta) -----
+const byte SYNC_STATUS = 0;             // ST_ flags (dscGlobal.pStatus)
+const byte SYNC_ARM    = 1;             // 0x02 armed, 0x03 disarmed, 0 not known
+const byte SYNC_USER   = 2;             // User code of the last arm/disarm
+const byte SYNC_ZONES  = 3;             // Zone groups from here, one bit per zone
+const byte SYNC_FIELDS = SYNC_ZONES + ZONE_GROUPS;
+
+// ----- Frame Types -----
+const byte SYNC_SNAPSHOT  = 'S';
+const byte SYNC_DELTA     = 'D';
+const byte SYNC_HEARTBEAT = 'H';
+const byte SYNC_RESYNC    = 'R';        // Sent by a client to ask for a snapshot
+
+const byte SYNC_HEAD = 4;               // type, len, seq (2)
+const byte SYNC_MAX_FRAME = SYNC_HEAD + (SYNC_FIELDS * 2) + 1;
+const unsigned int SYNC_HEARTBEAT_MS = 10000;   // Heartbeat after this long idle
+
+class DSCSync
+{
+  public:
+    // Class to call to initialize the sync encoder
+    // for example...  DSCSync sync;
+    DSCSync(void);
+
+    // Compares the decoded state of "dsc" to the last one sent and encodes a delta
+    // of the changed bits, or a heartbeat if nothing was sent for SYNC_HEARTBEAT_MS
+    // Returns:   the length of the encoded frame, 0 if there is none
+    byte update(DSC &dsc);
+
+    // Writes the frame encoded by the last update() to "out"
+    // Returns:   1 if the whole frame was written, 0 if not (the client is out of
+    //            sync, send it a snapshot)
+    int sendFrame(Print &out);
+
+    // Encodes and writes a snapshot of the state to "out" (new or resyncing client)
+    // Returns:   1 if the whole frame was written, 0 if not
+    int snapshot(Print &out);
+
+    // The frame encoded by the last update(), to write it some other way
+    const byte *frame(void);
+    byte frameLen(void);
+
+    // Sequence number of the last delta (and of the snapshots)
+    unsigned int sequence(void);
+
+    // Frames and bytes encoded (deltas and heartbeats, snapshots)
+    unsigned long deltas, heartbeats, snapshots;
+    unsigned long bytes;
+
+  private:
+    byte encode(byte *out, byte type, const byte *payload, byte n);
+
+    byte state[SYNC_FIELDS];        // State as of the last delta
+    byte buf[SYNC_MAX_FRAME];       // Last frame encoded by update()
+    byte len;
+    unsigned int seq;
+    unsigned long lastFrame;        // millis() of the last delta/heartbeat
+};
+
+#endif
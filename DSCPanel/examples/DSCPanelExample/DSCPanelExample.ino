@@ -7,6 +7,11 @@
 //      can also power your arduino from the keybus (+12 VDC, positive), depending on the 
 //      the type arduino board you have.
 //
+// This sketch fits an Uno with a W5100 Ethernet shield. The DSC object reserves
+// its word Strings in begin(), about 900 bytes of heap with DSC_PANEL 1864 (about
+// 710 with 1816), so keep additions to this sketch small on an Uno. DSCPanelMega
+// is the same sketch with the scheduler, diagnostics, state sync, audit and bus
+// analyzer modules and needs a Mega.
 //
 
 #include <SPI.h>
@@ -18,6 +23,7 @@
 // ----- Ethernet/WiFi Variables -----
 bool newClient = false;               // Whether the client is new or not
 bool streamData = false;              // Was the request to stream data? (/STREAM)
+unsigned long connTimeout = 0;        // millis() when a new client stops waiting for its request
 // Enter a MAC address and IP address for the controller:
 byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED };
 // Set a manual IP address in case DHCP Fails:
@@ -78,42 +84,39 @@ void loop()
     client = server.available();
     newClient = true;
     streamData = false;
+    connTimeout = millis() + 500;         // Set the timeout 500 ms from now
   }
   if (client and newClient) {
-    float connTimeout = millis() + 500;    // Set the timeout 500 ms from now
-    while(true) {
-      // If there is available data
-      if (client.available()) {
-        // Read the first two words of the request
-        String request_type = client.readStringUntil(' ');  // Read till the first space
-        String request = client.readStringUntil(' ');       // Read till the next space
-        Serial.print(F("Request: "));
-        Serial.print(request_type);
-        Serial.print(" ");
-        Serial.println(request);
-        //client.flush();
-        if (request == "/STREAM") {
-          streamData = true;
-          newClient = false;
-          for (int i=0; i <= 30; i++){
-            client.println(F("Empty --------------------------------------------------"));
-          } 
-        }
-        else {
-          streamData = false;
-          client.stop();
-          newClient = true;
-        }
-        break;
+    // If there is available data
+    if (client.available()) {
+      // Read the first two words of the request
+      String request_type = client.readStringUntil(' ');  // Read till the first space
+      String request = client.readStringUntil(' ');       // Read till the next space
+      Serial.print(F("Request: "));
+      Serial.print(request_type);
+      Serial.print(" ");
+      Serial.println(request);
+      //client.flush();
+      if (request == "/STREAM") {
+        streamData = true;
+        newClient = false;
+        for (int i=0; i <= 30; i++){
+          client.println(F("Empty --------------------------------------------------"));
+        } 
       }
-      // If not, wait up to [connTimeout] ms for data
-      if (millis() >= connTimeout) {
-        Serial.println(F("Connection Timeout"));
+      else {
         streamData = false;
         client.stop();
         newClient = true;
       }
-      delay(5);
+    }
+    // If not, wait up to [connTimeout] ms for data (checked again on the next pass,
+    // the words keep being decoded meanwhile)
+    else if ((long)(millis() - connTimeout) >= 0) {
+      Serial.println(F("Connection Timeout"));
+      streamData = false;
+      client.stop();
+      newClient = true;
     }
   }
  
@@ -130,7 +133,7 @@ void loop()
   // ---------------- Get/process incoming data ----------------
   if (!dsc.process()) return;
 
-  if (dsc.timeAvailable) setDscTime();    // Attempt to update the system time
+  if (dsc.clockChanged) setDscTime();     // Update the system time on a new panel minute
 
   if (dscGlobal.pCmd) {
     // ------------ Print the formatted raw data ------------
@@ -213,7 +216,7 @@ String digits(unsigned int val)
 
 void setDscTime()
 {
-  setTime(dsc.HH,dsc.MM,dsc.SS,dsc.dd,dsc.mm,dsc.yy);
+  setTime(dsc.panelTime);
   if (timeStatus() == timeSet) {
     Serial.println(F("Time Synchronized"));
   }
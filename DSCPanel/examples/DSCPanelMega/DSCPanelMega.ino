@@ -0,0 +1,379 @@
+// DSC_18XX Arduino Interface - Full Featured Example with Ethernet (Arduino Mega only)
+//
+// Sketch to decode the keybus protocol on DSC PowerSeries 1816, 1832 and 1864 panels
+//   -- Use the schematic at https://github.com/emcniece/Arduino-Keybus to connect the
+//      keybus lines to the arduino via voltage divider circuits.  Don't forget to 
+//      connect the Keybus Ground to Arduino Ground (not depicted on the circuit)! You
+//      can also power your arduino from the keybus (+12 VDC, positive), depending on the 
+//      the type arduino board you have.
+//
+// This is DSCPanelExample with every optional module: the task scheduler, the
+// memory diagnostics (/MEM), the state sync (/SYNC), the arm/disarm audit (/AUDIT),
+// the bus analyzer (/BUS) and the coalesced /STREAM output. Together they need
+// about 2 KB of RAM on top of DSCPanelExample:
+//   - DSCAudit about 660 bytes, the scheduler table about 46 bytes per task slot
+//   - DSCSync, the DSCNetWriter buffer (DSC_NET_BUFFER, 512 bytes on a Mega)
+//     and the dscBus_t window
+// The DSC object reserves its word Strings in begin(), about 900 bytes of heap
+// with DSC_PANEL 1864 (about 710 with 1816), as in every example. An Uno has 2 KB
+// of RAM in all, so this sketch needs a Mega 1280/2560 (8 KB), or a board with
+// more RAM (ESP8266, ESP32). Use DSCPanelExample on an Uno.
+//
+
+#if defined(__AVR__) && !defined(__AVR_ATmega1280__) && !defined(__AVR_ATmega2560__)
+#error "DSCPanelMega needs an Arduino Mega (RAM), use DSCPanelExample on this board"
+#endif
+
+#include <SPI.h>
+#include <Ethernet.h>
+#include <TextBuffer.h>
+#include <TimeLib.h>
+#include <DSC.h>
+#include <DSC_Scheduler.h>
+#include <DSC_Diag.h>
+#include <DSC_Sync.h>
+#include <DSC_Audit.h>
+#include <DSC_NetWriter.h>
+
+// ----- Ethernet/WiFi Variables -----
+bool newClient = false;               // Whether the client is new or not
+bool streamData = false;              // Was the request to stream data? (/STREAM)
+bool syncData = false;                // Was the request for the state sync? (/SYNC)
+bool alarmEvent = false;              // An alarm-critical word was seen, send it now
+unsigned long connTimeout = 0;        // millis() when a new client stops waiting for its request
+// Enter a MAC address and IP address for the controller:
+byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED };
+// Set a manual IP address in case DHCP Fails:
+IPAddress ip(192, 168, 1, 169);
+
+DSC dsc;                              // Initialize DSC.h library as "dsc"
+DSCScheduler sched;                   // Runs the loop() tasks below, decoding first
+DSCDiag diag;                         // Heap/stack diagnostics (/MEM and the report)
+DSCSync stateSync;                    // Snapshot/delta state sync (/SYNC), not "sync",
+                                      //   that is a libc function on ESP32/ESP8266
+DSCAudit audit;                       // Arm/disarm history by user code (/AUDIT)
+DSCNetWriter net;                     // Collects the /STREAM messages into packets
+dscBus_t bus;                         // Last bus analyzer window (/BUS)
+TextBuffer message(128);              // Initialize TextBuffer.h for print/client message
+TextBuffer timeBuf(24);               // Initialize TextBuffer.h for formatted time message
+
+EthernetServer server(80);            // Start Ethernet Server on Port 80
+EthernetClient client;                // Start Ethernet Client
+
+// --------------------------------------------------------------------------------------------------------
+// -----------------------------------------------  SETUP  ------------------------------------------------
+// --------------------------------------------------------------------------------------------------------
+
+void setup()
+{ 
+  diag.begin();                 // Paint the free RAM first, for the stack high water mark
+  diag.setGuard(256, 128, 128); // Warn below 256 bytes free, a 128 byte block or stack margin
+  diag.onGuard(memoryGuard);
+
+  Serial.begin(115200);
+  Serial.flush();
+  Serial.println(F("DSC Powerseries 18XX"));
+  Serial.println(F("Key Bus Monitor"));
+  Serial.println(F("Initializing"));
+
+  message.begin();              // Begin the message buffer, allocate memory
+  timeBuf.begin();              // Begin the formatted time buffer, allocate memory
+ 
+  // Start the Ethernet connection and the server (Try to use DHCP):
+  Serial.println(F("Trying to get an IP address using DHCP..."));
+  if (Ethernet.begin(mac) == 0) {
+    Serial.println(F("Trying to manually set IP address..."));
+    // Initialize the ethernet device using manual IP address:
+    if (1 == 0) {               // This logic is "shut off", doesn't work with Ethernet client
+      Serial.println(F("No ethernet connection"));
+    }
+    else {
+      Ethernet.begin(mac, ip);
+      server.begin();
+    }
+  }
+  Serial.print(F("Server is at: "));
+  Serial.println(Ethernet.localIP());
+  Serial.println();
+
+  dsc.setCLK(3);    // Sets the clock pin to 3 (example, this is also the default)
+                    // setDTA_IN( ), setDTA_OUT( ) and setLED( ) can also be called
+  dsc.begin();      // Start the dsc library (Sets the pin modes)
+  dsc.onCritical(alarmFound);   // Alarm-critical words skip the network buffering
+  dsc.analyze(true);            // Bus analyzer, tells a stalled bus from missed words
+
+  net.setFlush(DSC_NET_BUFFER, 50);   // Send when the buffer is full or after 50 ms
+
+  // The main loop tasks: decoding runs every pass and again between the other
+  // tasks, the tasks that go over their budget (us) are printed by taskReport()
+  sched.add(F("decode"), decodeTask, 0, SCHED_PRI_TOP);
+  byte t = sched.add(F("client"), clientTask, 0, 2);
+  sched.setLimits(t, 2000, 0);
+  t = sched.add(F("watchdog"), watchdogTask, 1000, 4);
+  sched.setLimits(t, 1000, 500);
+  sched.add(F("sync"), syncTask, 100, 1);
+  sched.add(F("net"), netTask, 10, 3);
+  sched.add(F("memory"), memoryTask, 5000, 5);
+  sched.add(F("report"), reportTask, 600000, SCHED_PRI_LOW);
+  sched.onReport(taskReport);
+}
+
+// --------------------------------------------------------------------------------------------------------
+// ---------------------------------------------  MAIN LOOP  ----------------------------------------------
+// --------------------------------------------------------------------------------------------------------
+
+void loop()
+{  
+  sched.run();
+}
+
+// --------------------------------------------------------------------------------------------------------
+// -----------------------------------------------  TASKS  ------------------------------------------------
+// --------------------------------------------------------------------------------------------------------
+
+void clientTask()
+{
+  // -------------- Check for a new connection --------------
+  if (!client.connected()) {
+    client = server.available();
+    newClient = true;
+    streamData = false;
+    syncData = false;
+    connTimeout = millis() + 500;         // Set the timeout 500 ms from now
+  }
+  if (client and newClient) {
+    // If there is available data
+    if (client.available()) {
+      // Read the first two words of the request
+      String request_type = client.readStringUntil(' ');  // Read till the first space
+      String request = client.readStringUntil(' ');       // Read till the next space
+      Serial.print(F("Request: "));
+      Serial.print(request_type);
+      Serial.print(" ");
+      Serial.println(request);
+      //client.flush();
+      if (request == "/STREAM") {
+        streamData = true;
+        newClient = false;
+        net.begin(client);                // The messages go out through "net"
+        for (int i=0; i <= 30; i++){
+          net.println(F("Empty --------------------------------------------------"));
+        } 
+      }
+      else if (request == "/SYNC") {
+        // Binary state sync: a snapshot now, then the deltas from syncTask()
+        syncData = true;
+        newClient = false;
+        stateSync.snapshot(client);
+      }
+      else if (request == "/MEM" || request == "/AUDIT" || request == "/BUS") {
+        // Memory diagnostics, the arm/disarm audit or the bus analyzer as plain text
+        client.println(F("HTTP/1.1 200 OK"));
+        client.println(F("Content-Type: text/plain"));
+        client.println(F("Connection: close"));
+        client.println();
+        if (request == "/MEM") diag.print(client);
+        else if (request == "/BUS") dsc.printBus(client);
+        else audit.print(client);
+        client.stop();
+        newClient = true;
+      }
+      else {
+        streamData = false;
+        client.stop();
+        newClient = true;
+      }
+    }
+    // If not, wait up to [connTimeout] ms for data (checked again on the next pass)
+    else if ((long)(millis() - connTimeout) >= 0) {
+      Serial.println(F("Connection Timeout"));
+      streamData = false;
+      client.stop();
+      newClient = true;
+    }
+  }
+}
+
+void watchdogTask()
+{
+  dsc.busSummary(bus);                    // Closes the bus window every second
+
+  // --------------- Print No Data Message -------------- (FOR DEBUG PURPOSES)
+  if ((millis() - dscGlobal.lastData) > 20000) {
+    // Print no data message if there is no new data in XX time (ms), with the
+    // last second of the bus: stalled, missed words or only repeated words
+    Serial.println(F("--- No data for 20 seconds ---"));  
+    dsc.printBus(Serial);
+    if (client.connected() and streamData) {
+      net.println(F("--- No data for 20 seconds ---")); 
+      dsc.printBus(net);
+    }
+    dscGlobal.lastData = millis();          // Reset the timer
+  }
+}
+
+void decodeTask()
+{
+  // ---------------- Get/process incoming data ----------------
+  if (!dsc.process()) return;
+
+  audit.update(dsc);                      // Records the arm/disarm of a new 0xa5 word
+
+  if (dsc.clockChanged) setDscTime();     // Update the system time on a new panel minute
+
+  if (dscGlobal.pCmd) {
+    // ------------ Print the formatted raw data ------------
+    //Serial.print(message.getBuffer());  // Prints unformatted word to serial
+    Serial.println(dsc.pnlFormat());
+
+    message.clear();                      // Clear the message Buffer (this sets first byte to 0)
+    message.print(formatTime(now()));     // Add the time stamp
+    message.print(" ");
+    if (String(dscGlobal.pCmd,HEX).length() == 1)
+      message.print("0");                 // Write a leading zero to a single digit HEX
+    message.print(String(dscGlobal.pCmd,HEX));
+    message.print("(");
+    message.print(dscGlobal.pCmd);
+    message.print("): ");
+    message.println(dscGlobal.pMsg);
+  
+    // ------------ Print the message ------------
+    Serial.print(message.getBuffer());
+    if (client.connected() and streamData) {
+      net.write((const uint8_t *)message.getBuffer(), message.getSize());
+    }
+  }
+
+  if (dscGlobal.kCmd) {
+    // ------------ Print the formatted raw data ------------
+    //Serial.print(message.getBuffer());  // Prints unformatted word to serial
+    Serial.println(dsc.kpdFormat());
+  
+    message.clear();                      // Clear the message Buffer (this sets first byte to 0)
+    message.print(formatTime(now()));     // Add the time stamp
+    message.print(" ");
+    if (String(dscGlobal.kCmd,HEX).length() == 1)
+      message.print("0");                 // Write a leading zero to a single digit HEX
+    message.print(String(dscGlobal.kCmd,HEX));
+    message.print("(");
+    message.print(dscGlobal.kCmd);
+    message.print("): ");
+    message.println(dscGlobal.kMsg);
+
+    // ------------ Print the message ------------
+    Serial.print(message.getBuffer());
+    if (client.connected() and streamData) {
+      net.write((const uint8_t *)message.getBuffer(), message.getSize());
+    }
+  }
+
+  // An alarm, alarm memory or arm/disarm goes out now, not with the next packet
+  if (alarmEvent) {
+    net.flush();
+    alarmEvent = false;
+  }
+}
+
+void alarmFound(const dscEvent_t & /*evt*/)
+{
+  // Called from dsc.process() before the words are decoded, so only the flag is set
+  alarmEvent = true;
+}
+
+void netTask()
+{
+  net.poll();                             // Sends the messages that waited 50 ms
+}
+
+void syncTask()
+{
+  // Encodes the state changes once, then writes them to the sync client. A client
+  // that lost a frame sends 'R' for a new snapshot. The pending delta goes out
+  // first: a snapshot carries the current sequence number, a delta sent after it
+  // would repeat that number
+  bool send = stateSync.update(dsc);
+  if (!(client.connected() and syncData)) return;
+  if (send && !stateSync.sendFrame(client)) stateSync.snapshot(client);
+  bool resync = false;
+  while (client.available()) {
+    if (client.read() == SYNC_RESYNC) resync = true;
+  }
+  if (resync) stateSync.snapshot(client);   // One snapshot for any number of 'R'
+}
+
+void memoryTask()
+{
+  diag.check(dsc);                        // Calls memoryGuard() if a threshold is crossed
+}
+
+void reportTask()
+{
+  sched.printReport(Serial);              // Task runtimes and memory, every 10 minutes
+  diag.print(Serial);
+  net.printStats(Serial);
+}
+
+void memoryGuard(byte /*flags*/, const dscMem_t & /*m*/)
+{
+  Serial.println(F("--- Memory guard ---"));
+  diag.print(Serial);
+}
+
+void taskReport(byte /*task*/, const dscTask_t &t, byte reason)
+{
+  Serial.print(F("--- Task "));
+  Serial.print(t.name);
+  if (reason == SCHED_OVER_BUDGET) {
+    Serial.print(F(" ran "));
+    Serial.print(t.lastRun);
+    Serial.println(F(" us ---"));
+  }
+  else Serial.println(F(" started late ---"));
+}
+
+// --------------------------------------------------------------------------------------------------------
+// ---------------------------------------------  FUNCTIONS  ----------------------------------------------
+// --------------------------------------------------------------------------------------------------------
+
+const char* formatTime(time_t cTime)
+{
+  timeBuf.clear();
+  timeBuf.print(digits(hour(cTime)));     timeBuf.print(":");
+  timeBuf.print(digits(minute(cTime)));   timeBuf.print(":");
+  timeBuf.print(digits(second(cTime)));   timeBuf.print(", ");
+  timeBuf.print(month(cTime));            timeBuf.print("/");
+  timeBuf.print(day(cTime));              timeBuf.print("/");
+  timeBuf.print(year(cTime)); 
+
+  return timeBuf.getBuffer();
+}
+
+/* // OLD formatTime - String was unstable
+String formatTime(time_t cTime)
+{
+  return digits(hour(cTime)) + ":" + digits(minute(cTime)) + ":" + digits(second(cTime)) + ", " +
+         String(month(cTime)) + "/" + String(day(cTime)) + "/" + String(year(cTime));  //+ "/20" 
+}
+*/
+
+String digits(unsigned int val)
+{
+  // Take an unsigned int and convert to a string with appropriate leading zeros
+  if (val < 10) return "0" + String(val);
+  else return String(val);
+}
+
+void setDscTime()
+{
+  setTime(dsc.panelTime);
+  if (timeStatus() == timeSet) {
+    Serial.println(F("Time Synchronized"));
+  }
+  else {
+    Serial.println(F("Time Sync Error"));
+  } 
+}
+
+// --------------------------------------------------------------------------------------------------------
+// ------------------------------------------------  END  -------------------------------------------------
+// --------------------------------------------------------------------------------------------------------
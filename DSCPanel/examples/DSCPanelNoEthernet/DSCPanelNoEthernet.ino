@@ -16,6 +16,7 @@
 DSC dsc;                              // Initialize DSC.h library as "dsc"
 TextBuffer message(128);              // Initialize TextBuffer.h for print/client message
 TextBuffer timeBuf(24);               // Initialize TextBuffer.h for formatted time message
+dscBus_t bus;                         // Last bus analyzer window (1 s)
 
 // --------------------------------------------------------------------------------------------------------
 // -----------------------------------------------  SETUP  ------------------------------------------------
@@ -35,6 +36,7 @@ void setup()
   dsc.setCLK(3);    // Sets the clock pin to 3 (example, this is also the default)
                     // setDTA_IN( ), setDTA_OUT( ) and setLED( ) can also be called
   dsc.begin();      // Start the dsc library (Sets the pin modes)
+  dsc.analyze(true);  // Bus analyzer, tells a stalled bus from missed words
 }
 
 // --------------------------------------------------------------------------------------------------------
@@ -43,18 +45,25 @@ void setup()
 
 void loop()
 {  
+  // ------------- Sleep until the next word arrives -------------
+  // Idles the MCU between words (saves power when running from the panel's
+  // aux supply), wakes at least once a second for the no data check below
+  dsc.idle(1000);
+  dsc.busSummary(bus);                    // Closes the bus window every second
  
   // --------------- Print No Data Message -------------- (FOR DEBUG PURPOSES)
   if ((millis() - dscGlobal.lastData) > 20000) {
-    // Print no data message if there is no new data in XX time (ms)
+    // Print no data message if there is no new data in XX time (ms), with the
+    // last second of the bus: stalled, missed words or only repeated words
     Serial.println(F("--- No data for 20 seconds ---"));  
+    dsc.printBus(Serial);
     dscGlobal.lastData = millis();          // Reset the timer
   }
 
   // ---------------- Get/process incoming data ----------------
   if (!dsc.process()) return;
 
-  if (dsc.timeAvailable) setDscTime();    // Attempt to update the system time
+  if (dsc.clockChanged) setDscTime();     // Update the system time on a new panel minute
 
   if (dscGlobal.pCmd) {
     // ------------ Print the formatted raw data ------------
@@ -132,7 +141,7 @@ String digits(unsigned int val)
 
 void setDscTime()
 {
-  setTime(dsc.HH,dsc.MM,dsc.SS,dsc.dd,dsc.mm,dsc.yy);
+  setTime(dsc.panelTime);
   if (timeStatus() == timeSet) {
     Serial.println(F("Time Synchronized"));
   }
@@ -0,0 +1,56 @@
+// DSC_18XX Arduino Interface - Raw Capture Recorder Example
+//
+// - Streams the raw keybus clock edges (time and data line level) to the serial
+//   port in the compact capture format of DSC_Recorder.h, nothing else is printed.
+//   Record it on the computer and convert it with the host tool in the repository:
+//      python3 dscrecord.py record /dev/ttyACM0 capture.dscr
+//      python3 dscrecord.py vcd capture.dscr capture.vcd      (for a waveform viewer)
+//      python3 dscrecord.py frames capture.dscr               (panel/keypad words)
+//
+// Sketch to decode the keybus protocol on DSC PowerSeries 1816, 1832 and 1864 panels
+//   -- Use the schematic at https://github.com/emcniece/Arduino-Keybus to connect the
+//      keybus lines to the arduino via voltage divider circuits.  Don't forget to 
+//      connect the Keybus Ground to Arduino Ground (not depicted on the circuit)! You
+//      can also power your arduino from the keybus (+12 VDC, positive), depending on the 
+//      the type arduino board you have.
+//
+//
+
+#include <DSC.h>
+
+DSC dsc;                  // Initialize DSC.h library as "dsc"
+DSCRecorder rec(128);     // Raw capture recorder, 2 x 128 byte buffers
+
+// --------------------------------------------------------------------------------------------------------
+// -----------------------------------------------  SETUP  ------------------------------------------------
+// --------------------------------------------------------------------------------------------------------
+
+void setup()
+{ 
+  Serial.begin(115200);
+  Serial.flush();
+ 
+  dsc.setCLK(3);          // Sets the clock pin to 3 (example, this is also the default)
+  dsc.begin();            // Start the dsc library (Sets the pin modes)
+
+  rec.begin();            // Allocate the capture buffers
+  rec.start(Serial);      // Write the capture header and start recording
+  dsc.setRecorder(&rec);  // Hand the clock edges from the ISR to the recorder
+}
+
+// --------------------------------------------------------------------------------------------------------
+// ---------------------------------------------  MAIN LOOP  ----------------------------------------------
+// --------------------------------------------------------------------------------------------------------
+
+void loop()
+{  
+  // ------------- Write the filled capture buffer -------------
+  rec.flush();
+
+  // ------------- Keep the decoder going (LED, events) -------------
+  dsc.process();
+}
+
+// --------------------------------------------------------------------------------------------------------
+// ------------------------------------------------  END  -------------------------------------------------
+// --------------------------------------------------------------------------------------------------------
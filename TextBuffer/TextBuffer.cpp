@@ -1,17 +1,30 @@
 #include "Arduino.h"
 #include "TextBuffer.h"
 
+unsigned int TextBuffer::allocCount = 0;
+unsigned int TextBuffer::freeCount = 0;
+unsigned int TextBuffer::failCount = 0;
+unsigned long TextBuffer::allocBytes = 0;
+
 TextBuffer::TextBuffer(unsigned int bufSize)
   {
     _bufSize = (bufSize + 3) & (~3);  // Makes sure size is a multiple of 4
                                       //   - required for the ESP8266 boards
+    buffer = NULL;                    // No buffer until begin()
+    capacity = 0;
   }
 
 int TextBuffer::begin()
   {
+    if (buffer) end();            // begin() again, don't leak the old buffer
     buffer = (byte*)malloc(sizeof(byte)*_bufSize);
     
-    if (!buffer) return 0;        // return failure if malloc fails
+    if (!buffer) {
+      failCount++;
+      return 0;                   // return failure if malloc fails
+    }
+    allocCount++;
+    allocBytes += _bufSize;
     capacity = _bufSize;
     memset(buffer, 0, capacity);  // Initialize by zeroing the entire array
     position = 0;                 // -- Not currently used --
@@ -21,7 +34,7 @@ int TextBuffer::begin()
 size_t TextBuffer::write(uint8_t character) 
   {
     if (!buffer) return 0;        // return failure
-    if((getSize() + 1) < capacity) {
+    if((unsigned int)(getSize() + 1) < capacity) {
       // Save the character to the end of the buffer, if there is room
       buffer[getSize()] = character;
       return 1;                   // return success (1 byte)
@@ -64,6 +77,10 @@ int TextBuffer::end()
   {
     if (!buffer) return 0;        // return failure
     free(buffer);
+    buffer = NULL;                // The other functions now return failure
+    freeCount++;
+    allocBytes -= capacity;
+    capacity = 0;
     return 1;                     // return success
   }
 
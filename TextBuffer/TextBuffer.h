@@ -75,6 +75,12 @@ class TextBuffer : public Print
     // - This is the NMEA0183 standard checksum
     int getCheckSum();
     
+    // Allocation counters of all TextBuffers (for heap diagnostics)
+    static unsigned int allocCount;   // Successful begin() calls
+    static unsigned int freeCount;    // end() calls that freed a buffer
+    static unsigned int failCount;    // begin() calls where malloc failed
+    static unsigned long allocBytes;  // Bytes allocated now (begin() minus end())
+    
   private:  
   
     // Pointer to the buffer char array
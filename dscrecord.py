@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# Host tool for the raw keybus captures of DSCRecorder (DSCPanel/DSC_Recorder.h)
+#
+#   dscrecord.py record PORT FILE [--baud 115200] [--seconds N]
+#       Saves the capture streamed by the DSCPanelRecorder example to FILE
+#   dscrecord.py vcd FILE OUT.vcd
+#       Converts a capture to a VCD file for a waveform viewer (GTKWave, PulseView)
+#   dscrecord.py frames FILE [--gap 5000]
+#       Rebuilds the panel and keypad words the way the ISR does and prints one
+#       per line, "P <bits>" or "K <bits>" with the time in us, to be fed to a
+#       host build of the decoder
+
+import argparse
+import sys
+import time
+
+MAGIC = b"DSCR"
+VERSION = 1
+NEW_WORD_INTV = 5200        # DSC_Constants.h, the ISR uses NEW_WORD_INTV - 200
+
+
+class EdgeDecoder:
+    """Incremental capture decoder, feed() the bytes as they arrive."""
+
+    def __init__(self):
+        self.header = b""
+        self.pending = b""
+        self.t = 0
+        self.overrun = False
+
+    def feed(self, data):
+        """Returns the list of (time_us, clk, data, overrun) edges completed by "data"."""
+        if len(self.header) < 5:
+            need = 5 - len(self.header)
+            self.header += data[:need]
+            data = data[need:]
+            if len(self.header) < 5:
+                return []
+            if self.header[:4] != MAGIC:
+                raise ValueError("not a DSC capture (bad header)")
+            if self.header[4] != VERSION:
+                raise ValueError("unsupported capture version %d" % self.header[4])
+
+        data = self.pending + data
+        out = []
+        pos = 0
+        start = 0
+        while pos < len(data):
+            start = pos
+            # Overrun marker, the non-minimal varint 0x80 0x00
+            if data[pos] == 0x80:
+                if pos + 1 >= len(data):
+                    break
+                if data[pos + 1] == 0x00:
+                    self.overrun = True
+                    pos += 2
+                    start = pos
+                    continue
+            v = 0
+            shift = 0
+            while pos < len(data):
+                b = data[pos]
+                pos += 1
+                v |= (b & 0x7f) << shift
+                shift += 7
+                if not b & 0x80:
+                    break
+            else:
+                break               # Edge continues in the next chunk
+            self.t += v >> 2
+            out.append((self.t, (v >> 1) & 1, v & 1, self.overrun))
+            self.overrun = False
+            start = pos
+        self.pending = data[start:]
+        return out
+
+
+class FrameBuilder:
+    """Rebuilds the panel and keypad words from the edges, like the ISR does."""
+
+    def __init__(self, gap=NEW_WORD_INTV - 200):
+        self.gap = gap
+        self.p_build = ""
+        self.k_build = ""
+        self.last = None
+
+    def edge(self, t, clk, dta, overrun=False):
+        """Returns the list of ("P" or "K", bits, time_us) words completed by the edge."""
+        out = []
+        if overrun:
+            self.p_build = self.k_build = ""    # Words cut by the overrun can't be trusted
+        if self.last is not None and t - self.last > self.gap:
+            if len(self.p_build) >= 8:
+                out.append(("P", self.p_build, self.last))
+            if len(self.k_build) >= 8:
+                out.append(("K", self.k_build, self.last))
+            self.p_build = self.k_build = ""
+        self.last = t
+        if clk:
+            self.p_build += str(dta)
+        else:
+            self.k_build += str(dta)
+        return out
+
+
+def edges(data):
+    """Yields (time_us, clk, data, overrun) for every edge of a capture."""
+    for e in EdgeDecoder().feed(data):
+        yield e
+
+
+def record(args):
+    import serial           # pyserial, only needed to record
+
+    port = serial.Serial(args.port, args.baud, timeout=0.5)
+    port.reset_input_buffer()
+    end = time.time() + args.seconds if args.seconds else None
+    synced = False
+    pending = b""
+    total = 0
+    with open(args.file, "wb") as f:
+        try:
+            while end is None or time.time() < end:
+                chunk = port.read(4096)
+                if not chunk:
+                    continue
+                if not synced:
+                    # Skip whatever was sent before the header (boot messages)
+                    pending += chunk
+                    i = pending.find(MAGIC)
+                    if i < 0:
+                        pending = pending[-3:]
+                        continue
+                    chunk = pending[i:]
+                    synced = True
+                f.write(chunk)
+                total += len(chunk)
+        except KeyboardInterrupt:
+            pass
+    if not synced:
+        sys.exit("no capture header received, is the recorder sketch running?")
+    print("%d bytes recorded" % total, file=sys.stderr)
+
+
+def vcd(args):
+    with open(args.file, "rb") as f:
+        data = f.read()
+    with open(args.out, "w") as out:
+        out.write("$timescale 1us $end\n")
+        out.write("$scope module keybus $end\n")
+        out.write("$var wire 1 c clk $end\n")
+        out.write("$var wire 1 d data $end\n")
+        out.write("$var wire 1 o overrun $end\n")
+        out.write("$upscope $end\n$enddefinitions $end\n")
+        out.write("#0\n$dumpvars\n0o\n$end\n")
+        last = (None, None)
+        marked = False
+        for t, clk, dta, overrun in edges(data):
+            out.write("#%d\n" % t)
+            if overrun != marked:
+                out.write("%do\n" % overrun)
+                marked = overrun
+            if clk != last[0]:
+                out.write("%dc\n" % clk)
+            if dta != last[1]:
+                out.write("%dd\n" % dta)
+            last = (clk, dta)
+
+
+def frames(args):
+    with open(args.file, "rb") as f:
+        data = f.read()
+    builder = FrameBuilder(args.gap)
+    for t, clk, dta, overrun in edges(data):
+        if overrun:
+            print("# overrun at %d us" % t)
+        for src, bits, end in builder.edge(t, clk, dta, overrun):
+            print("%s %s %d" % (src, bits, end))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="DSC keybus capture tool")
+    sub = parser.add_subparsers(dest="cmd")
+    sub.required = True
+
+    p = sub.add_parser("record", help="save a capture from the serial port")
+    p.add_argument("port")
+    p.add_argument("file")
+    p.add_argument("--baud", type=int, default=115200)
+    p.add_argument("--seconds", type=float, default=0,
+                   help="stop after this long (default: Ctrl-C)")
+    p.set_defaults(func=record)
+
+    p = sub.add_parser("vcd", help="convert a capture to VCD")
+    p.add_argument("file")
+    p.add_argument("out")
+    p.set_defaults(func=vcd)
+
+    p = sub.add_parser("frames", help="print the panel/keypad words")
+    p.add_argument("file")
+    p.add_argument("--gap", type=int, default=NEW_WORD_INTV - 200,
+                   help="new word gap in us (default %(default)s)")
+    p.set_defaults(func=frames)
+
+    args = parser.parse_args()
+    try:
+        args.func(args)
+    except ValueError as e:
+        sys.exit("%s: %s" % (args.file, e))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,653 @@
+/* dscbatch.cpp
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Batch decoder for recorded Keybus words, built on the decoder core (DSC_Core.h).
+ *
+ *    dscbatch [-j threads] [-s summary.json] [-r repeats] [-c reference.jsonl]
+ *             capture.txt > events.jsonl
+ *
+ * The input has one word per line, either as printed by "dscrecord.py frames"
+ * ("P <bits> [time_us]", "K <bits> [time_us]") or by the example sketches
+ * ("[Panel]  <bits> (OK)", "[Keypad] <bits>"). Other lines are counted and
+ * skipped. The output is one JSON object per decoded word or state change, in
+ * input order, and the summary statistics go to stderr (or to -s). Keypad words
+ * that fail the button check are counted as "key_invalid" and not output.
+ *
+ * The file is memory mapped and split at line ends into one chunk per thread.
+ * Each thread decodes its chunk with its own state (last panel word for the
+ * duplicate check, panel command for the keypad reply, status and zones for the
+ * change events). The words that depend on state from before the chunk (the
+ * first of each kind) are left pending and resolved when the chunks are merged
+ * in order, so the output is the same for any number of threads.
+ *
+ * Checking a decoder change: the output of a build from before the change is
+ * kept as a reference, and the new build is run on the same capture with
+ * "-c reference.jsonl". Nothing is written to stdout then, the first line that
+ * differs is printed and the exit status is 1. The summary has the decode time
+ * per word ("ns_per_word", the chunk decoding only, not the file or output), and
+ * "-r" decodes each chunk that many times and keeps the fastest, for steadier
+ * numbers to compare:
+ *    dscbatch -j 1 -r 5 -c before.jsonl capture.txt
+ */
+
+#include "DSC_Core.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ----- Names -----
+static const char *keyName[] =
+  { "1", "2", "3", "4", "5", "6", "7", "8", "9", "*", "0", "#",
+    "Stay", "Away", "Chime", "Reset", "Exit", "<", ">", "Fire", "Auxillary", "Panic" };
+
+// In ST_ flag bit order
+static const char *statusName[] =
+  { "ready", "armed", "memory", "bypass", "error", "program", "power_fail" };
+
+// ----- Decoder State (carried from word to word, and chunk to chunk) -----
+struct State
+  {
+    bool havePanelCmd;              // panelCmd is known
+    byte panelCmd;                  // Command of the last panel word (keypad replies)
+    bool havePanel;                 // lastPanel is known
+    dscFrame_t lastPanel;           // Last new panel word (duplicate check)
+    bool haveStatus;
+    byte status;
+    byte zoneKnown;                 // Zone groups with a known state (bit per group)
+    byte zones[ZONE_GROUPS];
+  };
+
+// ----- Statistics -----
+struct Stats
+  {
+    unsigned long lines, unparsed;
+    unsigned long panel, keypad;    // Words read
+    unsigned long decoded;          // New words decoded (not duplicates or idle)
+    unsigned long duplicates, idle, shortWords, crcErrors, keyInvalid, changes;
+    unsigned long cmdCount[256];
+    unsigned long zoneOpened[ZONE_GROUPS * 8];
+
+    void add(const Stats &s)
+      {
+        lines += s.lines, unparsed += s.unparsed;
+        panel += s.panel, keypad += s.keypad;
+        decoded += s.decoded, duplicates += s.duplicates, idle += s.idle;
+        shortWords += s.shortWords, crcErrors += s.crcErrors;
+        keyInvalid += s.keyInvalid, changes += s.changes;
+        for (int i=0;i<256;i++) cmdCount[i] += s.cmdCount[i];
+        for (int i=0;i<ZONE_GROUPS*8;i++) zoneOpened[i] += s.zoneOpened[i];
+      }
+  };
+
+// One word of the input
+struct Word
+  {
+    char src;                       // 'P' or 'K'
+    unsigned long line;             // Line number (from 1)
+    long long time;                 // Time in us, -1 if the line has none
+    dscFrame_t frame;
+  };
+
+// Output of one chunk: rendered text, with the pending words in between
+struct Chunk
+  {
+    const char *start, *end;
+    unsigned long firstLine;
+    std::string text;
+    std::vector<size_t> cut;        // Offsets in text where pending[i] goes
+    std::vector<Word> pending;
+    std::vector<State> before;      // Chunk state before pending[i] (what it knows)
+    State state;                    // State at the end of the chunk
+    Stats stats;
+    double seconds;                 // Decode time (fastest of the repeats)
+  };
+
+// Where the merged output goes: stdout, or compared to a reference output
+struct Sink
+  {
+    const char *ref;                // Reference output (-c), NULL to write
+    size_t refSize;
+    size_t pos;                     // Bytes output so far
+    bool differs;
+    size_t at;                      // Offset of the first difference
+    std::string got;                // Output from the difference to its line end
+
+    void write(const char *p, size_t n)
+      {
+        if (!ref) {
+          fwrite(p, 1, n, stdout);
+          return;
+        }
+        if (!differs) {
+          size_t same = 0;
+          while (same < n && pos + same < refSize && p[same] == ref[pos + same]) same++;
+          if (same < n) {
+            differs = true;
+            at = pos + same;
+            // The output is written in whole lines, so the rest of this line is here
+            const char *eol = (const char *)memchr(p + same, '\n', n - same);
+            got.assign(p + same, eol ? eol - (p + same) : n - same);
+          }
+        }
+        pos += n;
+      }
+  };
+
+// ----- Output Helpers -----
+static void addHex(std::string &out, byte b)
+  {
+    static const char digits[] = "0123456789abcdef";
+    out += digits[b >> 4];
+    out += digits[b & 0x0f];
+  }
+
+static void addHead(std::string &out, const Word &w)
+  {
+    out += "{\"line\":";
+    out += std::to_string(w.line);
+    if (w.time >= 0) {
+      out += ",\"time\":";
+      out += std::to_string(w.time);
+    }
+  }
+
+static void addStatus(std::string &out, byte st)
+  {
+    out += '[';
+    bool first = true;
+    for (byte i=0;i<7;i++) {
+      if (!(st & (1 << i))) continue;
+      if (!first) out += ',';
+      out += '"';
+      out += statusName[i];
+      out += '"';
+      first = false;
+    }
+    out += ']';
+  }
+
+// Returns true if rendering the word needs state that "s" doesn't have
+static bool needsState(const Word &w, const State &s)
+  {
+    if (w.src != 'P') return !s.havePanelCmd;
+    byte cmd = dscFrameBits(w.frame, 0, 8);
+    if (!cmd) return false;
+    if (!s.havePanel) return true;
+    if (dscFrameEqual(w.frame, s.lastPanel)) return false;    // Duplicate either way
+    if (cmd == 0x05 && !s.haveStatus) return true;
+    for (byte grp=0;grp<ZONE_GROUPS;grp++)
+      if (cmd == zoneCmd[grp] && !(s.zoneKnown & (1 << grp))) return true;
+    return false;
+  }
+
+/* Decodes one word with state "s", adds its JSON lines to "out" (if not NULL)
+ * and counts it in "st" (if not NULL). The state is updated either way, a word
+ * rendered without a known state marks that state as known from here on.
+ */
+static void render(const Word &w, State &s, std::string *out, Stats *st)
+  {
+    if (w.src == 'K') {
+      dscKeypadInfo_t info;
+      byte cmd = dscDecodeKeypad(w.frame, s.panelCmd, info);
+      if (info.type == KPD_IDLE) {
+        if (st) st->idle++;
+        return;
+      }
+      if (info.type == KPD_INVALID) {
+        if (st) st->keyInvalid++;
+        return;
+      }
+      if (st) st->decoded++, st->cmdCount[cmd]++;
+      if (!out) return;
+      addHead(*out, w);
+      *out += ",\"src\":\"keypad\",\"cmd\":\"";
+      addHex(*out, cmd);
+      *out += "\",\"data\":\"";
+      addHex(*out, info.data);
+      *out += '"';
+      if (info.key != KEY_NONE) {
+        *out += ",\"key\":\"";
+        *out += keyName[info.key];
+        *out += '"';
+      }
+      if (info.type == KPD_SLOTS) {
+        *out += ",\"slots\":[";
+        bool first = true;
+        for (byte i=0;i<KPD_SLOT_COUNT;i++) {
+          if (!(info.slots & (1 << i))) continue;
+          if (!first) *out += ',';
+          *out += std::to_string(i + 1);
+          first = false;
+        }
+        *out += ']';
+      }
+      *out += "}\n";
+      return;
+    }
+
+    dscPanelInfo_t info;
+    byte cmd = dscDecodePanel(w.frame, info);
+    s.havePanelCmd = true;
+    s.panelCmd = cmd;
+    if (!cmd) {
+      // Empty, or too short for the fields of its command
+      if (st) {
+        if (dscFrameBits(w.frame, 0, 8)) st->shortWords++;
+        else st->idle++;
+      }
+      return;
+    }
+    if (s.havePanel && dscFrameEqual(w.frame, s.lastPanel)) {
+      if (st) st->duplicates++;
+      return;
+    }
+    bool statusKnown = s.haveStatus;
+    byte oldStatus = s.status;
+    byte grp = info.zoneGroup;
+    bool zonesKnown = (grp != ZONE_NONE) && (s.zoneKnown & (1 << grp));
+    byte oldZones = zonesKnown ? s.zones[grp] : 0;
+
+    s.havePanel = true;
+    s.lastPanel = w.frame;
+    if (cmd == 0x05) s.haveStatus = true, s.status = info.status;
+    if (grp != ZONE_NONE) s.zoneKnown |= (1 << grp), s.zones[grp] = info.zones;
+
+    if (st) {
+      st->decoded++, st->cmdCount[cmd]++;
+      if (!info.crc) st->crcErrors++;
+      if (zonesKnown)
+        for (byte i=0;i<8;i++)
+          if ((info.zones & ~oldZones) & (1 << i)) st->zoneOpened[grp * 8 + i]++;
+    }
+    if (!out) return;
+
+    // ----- The word -----
+    addHead(*out, w);
+    *out += ",\"src\":\"panel\",\"cmd\":\"";
+    addHex(*out, cmd);
+    *out += "\",\"crc\":";
+    *out += info.crc ? "true" : "false";
+    if (cmd == 0x05 || cmd == 0x0a) {
+      *out += ",\"status\":";
+      addStatus(*out, info.status);
+    }
+    if (cmd == 0x0a) {
+      *out += ",\"mode\":\"";
+      addHex(*out, info.mode);
+      *out += '"';
+    }
+    if (cmd == 0xa5) {
+      char buf[64];
+      if (info.timeValid) {
+        snprintf(buf, sizeof(buf), ",\"date\":\"%04u-%02u-%02u %02u:%02u\"",
+                 2000 + info.year, info.month, info.day, info.hour, info.minute);
+        *out += buf;
+      }
+      snprintf(buf, sizeof(buf), ",\"arm\":%u,\"user\":%u", info.arm, info.user);
+      *out += buf;
+    }
+    if (grp != ZONE_NONE) {
+      *out += ",\"zones\":[";
+      bool first = true;
+      for (byte i=0;i<8;i++) {
+        if (!(info.zones & (1 << i))) continue;
+        if (!first) *out += ',';
+        *out += std::to_string(grp * 8 + i + 1);
+        first = false;
+      }
+      *out += ']';
+    }
+    if (cmd == 0x64 || cmd == 0x69) {
+      *out += ",\"beeps\":";
+      *out += std::to_string(info.beeps);
+    }
+    *out += "}\n";
+
+    // ----- State changes -----
+    if (cmd == 0x05 && statusKnown && oldStatus != info.status) {
+      addHead(*out, w);
+      *out += ",\"event\":\"status\",\"set\":";
+      addStatus(*out, info.status & ~oldStatus);
+      *out += ",\"cleared\":";
+      addStatus(*out, oldStatus & ~info.status);
+      *out += "}\n";
+      if (st) st->changes++;
+    }
+    if (zonesKnown && oldZones != info.zones) {
+      for (byte i=0;i<8;i++) {
+        byte bit = 1 << i;
+        if (!((oldZones ^ info.zones) & bit)) continue;
+        addHead(*out, w);
+        *out += ",\"event\":\"zone\",\"zone\":";
+        *out += std::to_string(grp * 8 + i + 1);
+        *out += (info.zones & bit) ? ",\"open\":true}\n" : ",\"open\":false}\n";
+        if (st) st->changes++;
+      }
+    }
+    if (cmd == 0xa5 && info.arm >= 0x02) {
+      addHead(*out, w);
+      *out += (info.arm == 0x02) ? ",\"event\":\"armed\"" : ",\"event\":\"disarmed\"";
+      *out += ",\"user\":";
+      *out += std::to_string(info.user);
+      *out += "}\n";
+      if (st) st->changes++;
+    }
+  }
+
+// ----- Parsing -----
+// Reads the word of one line, returns false if the line doesn't hold one
+static bool parseLine(const char *p, const char *end, Word &w)
+  {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    bool grouped = true;            // The sketches print the bits in groups
+    if (end - p >= 2 && (*p == 'P' || *p == 'K') && p[1] == ' ') {
+      w.src = *p;
+      p += 2;
+      grouped = false;
+    }
+    else if (end - p >= 7 && !memcmp(p, "[Panel]", 7)) w.src = 'P', p += 7;
+    else if (end - p >= 8 && !memcmp(p, "[Keypad]", 8)) w.src = 'K', p += 8;
+    else return false;
+
+    while (p < end && *p == ' ') p++;
+    dscFrameClear(w.frame);
+    while (p < end && ((grouped && *p == ' ') || *p == '0' || *p == '1')) {
+      if (*p != ' ') dscFramePush(w.frame, *p == '1');
+      p++;
+    }
+    if (w.frame.len == 0) return false;
+
+    w.time = -1;
+    while (!grouped && p < end && *p == ' ') p++;
+    if (!grouped && p < end && *p >= '0' && *p <= '9') {
+      long long t = 0;
+      // Digits past 18 are skipped, the value would overflow
+      for (int n=0;p < end && *p >= '0' && *p <= '9';n++, p++)
+        if (n < 18) t = t * 10 + (*p - '0');
+      w.time = t;
+    }
+    return true;
+  }
+
+static void decodeChunk(Chunk &c)
+  {
+    memset(&c.state, 0, sizeof(State));
+    memset(&c.stats, 0, sizeof(Stats));
+    c.text.clear();
+    c.cut.clear();
+    c.pending.clear();
+    c.before.clear();
+    c.text.reserve((c.end - c.start) / 2);
+
+    Word w;
+    w.line = c.firstLine;
+    const char *p = c.start;
+    while (p < c.end) {
+      const char *eol = (const char *)memchr(p, '\n', c.end - p);
+      if (!eol) eol = c.end;
+      c.stats.lines++;
+      if (parseLine(p, eol, w)) {
+        if (w.src == 'P') c.stats.panel++;
+        else c.stats.keypad++;
+        if (needsState(w, c.state)) {
+          // Rendered at the merge, with the state of the chunks before
+          c.cut.push_back(c.text.size());
+          c.pending.push_back(w);
+          c.before.push_back(c.state);
+          render(w, c.state, NULL, NULL);
+        }
+        else render(w, c.state, &c.text, &c.stats);
+      }
+      else if (eol > p && !(eol - p == 1 && *p == '\r')) c.stats.unparsed++;
+      w.line++;
+      p = eol + 1;
+    }
+  }
+
+// Carries what the chunk state "c" knows into the merge state
+static void carry(State &s, const State &c)
+  {
+    if (c.havePanelCmd) s.havePanelCmd = true, s.panelCmd = c.panelCmd;
+    if (c.havePanel) s.havePanel = true, s.lastPanel = c.lastPanel;
+    if (c.haveStatus) s.haveStatus = true, s.status = c.status;
+    for (byte grp=0;grp<ZONE_GROUPS;grp++)
+      if (c.zoneKnown & (1 << grp)) s.zoneKnown |= (1 << grp), s.zones[grp] = c.zones[grp];
+  }
+
+// Decodes a chunk "repeats" times (the same result each time), keeps the fastest
+static void timeChunk(Chunk &c, int repeats)
+  {
+    c.seconds = 0;
+    for (int r=0;r<repeats;r++) {
+      auto start = std::chrono::steady_clock::now();
+      decodeChunk(c);
+      double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      if (r == 0 || t < c.seconds) c.seconds = t;
+    }
+  }
+
+// Maps a whole file read only, returns NULL (and size 0) for an empty file
+static const char *mapFile(const char *path, size_t &size, int &fd)
+  {
+    size = 0;
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+      perror(path);
+      exit(1);
+    }
+    struct stat sb;
+    if (fstat(fd, &sb) < 0) {
+      perror(path);
+      exit(1);
+    }
+    size = sb.st_size;
+    if (!size) return NULL;
+    const char *data = (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      perror(path);
+      exit(1);
+    }
+    madvise((void *)data, size, MADV_SEQUENTIAL);
+    return data;
+  }
+
+static void usage(void)
+  {
+    fprintf(stderr, "usage: dscbatch [-j threads] [-s summary.json] [-r repeats] "
+                    "[-c reference.jsonl] capture.txt\n");
+    exit(2);
+  }
+
+int main(int argc, char **argv)
+  {
+    unsigned int threads = std::thread::hardware_concurrency();
+    const char *summaryPath = NULL;
+    const char *refPath = NULL;
+    int repeats = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:s:r:c:")) != -1) {
+      if (opt == 'j') threads = atoi(optarg);
+      else if (opt == 's') summaryPath = optarg;
+      else if (opt == 'r') repeats = atoi(optarg);
+      else if (opt == 'c') refPath = optarg;
+      else usage();
+    }
+    if (optind != argc - 1) usage();
+    if (threads < 1) threads = 1;
+    if (repeats < 1) repeats = 1;
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    // ----- Map the files -----
+    size_t size;
+    int fd;
+    const char *data = mapFile(argv[optind], size, fd);
+    Sink sink;
+    sink.ref = NULL;
+    sink.refSize = sink.pos = sink.at = 0;
+    sink.differs = false;
+    int refFd = -1;
+    if (refPath) {
+      sink.ref = mapFile(refPath, sink.refSize, refFd);
+      if (!sink.ref) sink.ref = "";       // Empty reference, still compared
+    }
+
+    // ----- Split at line ends -----
+    if (size < threads * 4096UL) threads = size / 4096 + 1;   // Not worth a thread
+    std::vector<Chunk> chunks(threads);
+    const char *p = data;
+    for (unsigned int i=0;i<threads;i++) {
+      const char *end = (i == threads - 1) ? data + size : data + size * (i + 1) / threads;
+      if (end < p) end = p;
+      const char *nl = end < data + size ? (const char *)memchr(end, '\n', data + size - end) : NULL;
+      if (i < threads - 1) end = nl ? nl + 1 : data + size;
+      chunks[i].start = p;
+      chunks[i].end = end;
+      p = end;
+    }
+
+    // Line numbers of the chunk starts (a memchr pass, much cheaper than decoding)
+    std::vector<std::thread> pool;
+    std::vector<unsigned long> lineCount(threads, 0);
+    for (unsigned int i=0;i<threads;i++)
+      pool.push_back(std::thread([&chunks, &lineCount, i]() {
+        for (const char *q = chunks[i].start; q < chunks[i].end; q++) {
+          q = (const char *)memchr(q, '\n', chunks[i].end - q);
+          if (!q) break;
+          lineCount[i]++;
+        }
+      }));
+    for (auto &t : pool) t.join();
+    pool.clear();
+    unsigned long line = 1;
+    for (unsigned int i=0;i<threads;i++) {
+      chunks[i].firstLine = line;
+      line += lineCount[i];
+    }
+
+    // ----- Decode in parallel -----
+    for (unsigned int i=0;i<threads;i++)
+      pool.push_back(std::thread(timeChunk, std::ref(chunks[i]), repeats));
+    for (auto &t : pool) t.join();
+
+    // ----- Merge in order -----
+    State state;
+    Stats total;
+    memset(&state, 0, sizeof(State));
+    memset(&total, 0, sizeof(Stats));
+    std::string resolved;
+    for (auto &c : chunks) {
+      size_t from = 0;
+      for (size_t i=0;i<c.pending.size();i++) {
+        sink.write(c.text.data() + from, c.cut[i] - from);
+        from = c.cut[i];
+        // The state before the pending word: the chunks before, updated with
+        // what this chunk had seen up to the word
+        State s = state;
+        carry(s, c.before[i]);
+        resolved.clear();
+        render(c.pending[i], s, &resolved, &total);
+        sink.write(resolved.data(), resolved.size());
+      }
+      sink.write(c.text.data() + from, c.text.size() - from);
+      total.add(c.stats);
+      carry(state, c.state);
+      std::string().swap(c.text);
+    }
+    fflush(stdout);
+
+    // ----- Compare -----
+    if (refPath && !sink.differs && sink.pos != sink.refSize) {
+      sink.differs = true;                // The reference has more lines
+      sink.at = sink.pos;
+    }
+    if (sink.differs) {
+      // Both are the same up to "at", its line starts after the last line end
+      size_t bol = sink.at;
+      while (bol > 0 && sink.ref[bol - 1] != '\n') bol--;
+      unsigned long outLine = 1;
+      for (size_t i=0;i<bol;i++)
+        if (sink.ref[i] == '\n') outLine++;
+      fprintf(stderr, "dscbatch: output differs from %s at line %lu\n", refPath, outLine);
+      if (bol < sink.refSize) {
+        const char *eol = (const char *)memchr(sink.ref + bol, '\n', sink.refSize - bol);
+        size_t len = eol ? eol - (sink.ref + bol) : sink.refSize - bol;
+        fprintf(stderr, "  reference: %.*s\n", (int)len, sink.ref + bol);
+      }
+      else fprintf(stderr, "  reference: (end)\n");
+      if (sink.at < sink.pos)
+        fprintf(stderr, "  output:    %.*s%s\n", (int)(sink.at - bol), sink.ref + bol, sink.got.c_str());
+      else fprintf(stderr, "  output:    (end)\n");
+    }
+    if (refFd >= 0) {
+      if (sink.refSize) munmap((void *)sink.ref, sink.refSize);
+      close(refFd);
+    }
+
+    if (data) munmap((void *)data, size);
+    close(fd);
+
+    // ----- Summary -----
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    // Decode time summed over the chunks (thread time, more than the wall time)
+    double decodeSecs = 0;
+    for (auto &c : chunks) decodeSecs += c.seconds;
+    unsigned long words = total.panel + total.keypad;
+    double nsPerWord = words ? decodeSecs * 1e9 / words : 0;
+    std::string sum = "{\"lines\":" + std::to_string(total.lines) +
+        ",\"unparsed\":" + std::to_string(total.unparsed) +
+        ",\"panel\":" + std::to_string(total.panel) +
+        ",\"keypad\":" + std::to_string(total.keypad) +
+        ",\"decoded\":" + std::to_string(total.decoded) +
+        ",\"duplicates\":" + std::to_string(total.duplicates) +
+        ",\"idle\":" + std::to_string(total.idle) +
+        ",\"short\":" + std::to_string(total.shortWords) +
+        ",\"crc_errors\":" + std::to_string(total.crcErrors) +
+        ",\"key_invalid\":" + std::to_string(total.keyInvalid) +
+        ",\"changes\":" + std::to_string(total.changes) +
+        ",\"threads\":" + std::to_string(threads) +
+        ",\"seconds\":" + std::to_string(secs) +
+        ",\"decode_seconds\":" + std::to_string(decodeSecs) +
+        ",\"ns_per_word\":" + std::to_string(nsPerWord) +
+        ",\"repeats\":" + std::to_string(repeats);
+    if (refPath) sum += std::string(",\"reference\":") + (sink.differs ? "\"differs\"" : "\"same\"");
+    sum += ",\"commands\":{";
+    bool first = true;
+    for (int i=0;i<256;i++) {
+      if (!total.cmdCount[i]) continue;
+      if (!first) sum += ',';
+      sum += '"';
+      addHex(sum, i);
+      sum += "\":" + std::to_string(total.cmdCount[i]);
+      first = false;
+    }
+    sum += "},\"zone_opened\":{";
+    first = true;
+    for (int i=0;i<ZONE_GROUPS*8;i++) {
+      if (!total.zoneOpened[i]) continue;
+      if (!first) sum += ',';
+      sum += "\"" + std::to_string(i + 1) + "\":" + std::to_string(total.zoneOpened[i]);
+      first = false;
+    }
+    sum += "}}\n";
+
+    FILE *sf = summaryPath ? fopen(summaryPath, "w") : stderr;
+    if (!sf) {
+      perror(summaryPath);
+      return 1;
+    }
+    fputs(sum.c_str(), sf);
+    if (sf != stderr) fclose(sf);
+    return sink.differs ? 1 : 0;
+  }
@@ -0,0 +1,164 @@
+/* dscfuzz.cpp
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Fuzz target for the word decoding, built with -DDSC_FUZZ=ON (CMakeLists.txt).
+ *
+ *    dscfuzz -max_len=512 corpus/               (clang, libFuzzer)
+ *    dscfuzz corpus/ [file]...                  (other compilers, runs the files)
+ *
+ * The input is a panel word as text, optionally followed by a newline and the
+ * keypad word sent in the same word period ("00000101010000001...\n1111..."),
+ * '1' is a 1 bit and any other character a 0. Each input goes through:
+ *  - the decoder core: dscFrameFromText(), dscDecodePanel() and
+ *    dscDecodeKeypad() with the panel word's command
+ *  - the DSC class (the String adapter): the bits are clocked into its ISR on
+ *    the host shim, the word is taken by process() and formatted by pnlFormat(),
+ *    kpdFormat(), pnlRaw() and kpdRaw()
+ * Both sides get words of any length, the short words and the words longer
+ * than the ISR keeps (MAX_BITS) included. The DSC object is kept from input to
+ * input like on the MCU, so the duplicate and keypad reply checks see the word
+ * before.
+ *
+ * Without libFuzzer (DSC_FUZZ_MAIN) the main() below runs each file, or each
+ * file of a directory, once: the seed corpus under the sanitizers (ctest).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "DSC.h"
+#include "DSC_Core.h"
+
+const unsigned long FUZZ_HALF_US = 500;     // Clock half period of the fed edges
+const unsigned long FUZZ_GAP_US = 7000;     // Gap between the words
+const unsigned int FUZZ_MAX_EDGES = 1024;   // Bit periods fed to the ISR, at most
+const byte FUZZ_CLK = 3;
+const byte FUZZ_DTA = 4;
+
+static DSC dsc;
+
+// One clock edge into the ISR, "us" after the last one
+static void edge(unsigned long us, int clk, int dta)
+  {
+    hostAdvance(us);
+    hostPin(FUZZ_CLK, clk);
+    hostPin(FUZZ_DTA, dta);
+    hostInterrupt(FUZZ_CLK);
+  }
+
+static void fuzzCore(const char *p, size_t pLen, const char *k, size_t kLen)
+  {
+    dscFrame_t pf, kf;
+    dscPanelInfo_t pInfo;
+    dscKeypadInfo_t kInfo;
+    dscFrameFromText(pf, p, pLen);
+    dscFrameFromText(kf, k, kLen);
+    byte cmd = dscDecodePanel(pf, pInfo);
+    dscDecodeKeypad(kf, cmd, kInfo);
+    dscPanelChecksum(pf);
+    dscFrameHasZero(kf);
+    dscFrameEqual(pf, kf);
+  }
+
+static void fuzzAdapter(const char *p, size_t pLen, const char *k, size_t kLen)
+  {
+    // The word as the bus sends it: the keypad bit on the falling edge, the
+    // panel bit on the rising edge, then the gap and the next word's first edge
+    size_t n = (pLen > kLen) ? pLen : kLen;
+    if (n > FUZZ_MAX_EDGES) n = FUZZ_MAX_EDGES;
+    for (size_t i=0;i<n;i++) {
+      edge(i ? FUZZ_HALF_US : FUZZ_GAP_US, 0, (i < kLen) ? k[i] == '1' : 1);
+      edge(FUZZ_HALF_US, 1, (i < pLen) ? p[i] == '1' : 1);
+    }
+    edge(FUZZ_GAP_US, 0, 1);
+    if (!dsc.process()) return;
+    // The text functions return NULL without a decoded word, checked like the sketches do
+    volatile size_t out = 0;        // Keeps the formatting from being optimized out
+    if (dscGlobal.pCmd) {
+      out += strlen(dsc.pnlFormat());
+      out += strlen(dsc.pnlRaw());
+      out += dscGlobal.pMsg.length();
+    }
+    if (dscGlobal.kCmd) {
+      out += strlen(dsc.kpdFormat());
+      out += strlen(dsc.kpdRaw());
+      out += dscGlobal.kMsg.length();
+    }
+  }
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+  {
+    static bool started = false;
+    if (!started) {
+      dsc.setCLK(FUZZ_CLK);
+      dsc.begin();
+      started = true;
+    }
+    const char *p = (const char *)data;
+    const char *nl = (const char *)memchr(p, '\n', size);
+    size_t pLen = nl ? (size_t)(nl - p) : size;
+    const char *k = nl ? nl + 1 : p + size;
+    size_t kLen = size - (k - p);
+
+    fuzzCore(p, pLen, k, kLen);
+    fuzzAdapter(p, pLen, k, kLen);
+    return 0;
+  }
+
+#if defined(DSC_FUZZ_MAIN)
+static int runFile(const char *path)
+  {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+      perror(path);
+      return 0;
+    }
+    std::string data;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.append(buf, n);
+    fclose(f);
+    LLVMFuzzerTestOneInput((const uint8_t *)data.data(), data.size());
+    return 1;
+  }
+
+int main(int argc, char **argv)
+  {
+    int runs = 0, failed = 0;
+    for (int i=1;i<argc;i++) {
+      struct stat st;
+      if (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(argv[i]);
+        if (!dir) {
+          perror(argv[i]);
+          failed++;
+          continue;
+        }
+        // In name order, the DSC object keeps the state of the input before
+        std::vector<std::string> names;
+        struct dirent *e;
+        while ((e = readdir(dir)) != NULL)
+          if (e->d_name[0] != '.') names.push_back(e->d_name);
+        closedir(dir);
+        std::sort(names.begin(), names.end());
+        for (auto &name : names) {
+          std::string path = std::string(argv[i]) + "/" + name;
+          if (runFile(path.c_str())) runs++;
+          else failed++;
+        }
+      }
+      else if (runFile(argv[i])) runs++;
+      else failed++;
+    }
+    printf("dscfuzz: %d inputs run\n", runs);
+    return (failed || !runs) ? 1 : 0;
+  }
+#endif
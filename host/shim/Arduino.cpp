@@ -0,0 +1,429 @@
+/* Arduino.cpp (host shim)
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * The simulated core behind Arduino.h: time only moves with hostAdvance(), the
+ * pins hold what hostPin()/digitalWrite() set, and interrupts() and
+ * noInterrupts() do nothing, since the handlers only run from hostInterrupt().
+ */
+
+#include "Arduino.h"
+
+#include <stdio.h>
+#include <ctype.h>
+
+static unsigned long hostMicros = 0;
+static int hostPins[256];
+static void (*hostHandlers[8])(void);
+static void (*hostYieldFn)(void) = NULL;
+
+HardwareSerial Serial;
+
+// ----- Time -----
+unsigned long millis(void)
+  {
+    return hostMicros / 1000;
+  }
+
+unsigned long micros(void)
+  {
+    return hostMicros;
+  }
+
+void delay(unsigned long ms)
+  {
+    hostMicros += ms * 1000;
+  }
+
+void delayMicroseconds(unsigned int us)
+  {
+    hostMicros += us;
+  }
+
+void yield(void)
+  {
+    if (hostYieldFn) hostYieldFn();
+  }
+
+// ----- Pins and Interrupts -----
+void pinMode(uint8_t pin, uint8_t mode)
+  {
+    if (mode == INPUT_PULLUP) hostPins[pin] = HIGH;
+  }
+
+int digitalRead(uint8_t pin)
+  {
+    return hostPins[pin];
+  }
+
+void digitalWrite(uint8_t pin, uint8_t val)
+  {
+    hostPins[pin] = val ? HIGH : LOW;
+  }
+
+int digitalPinToInterrupt(uint8_t pin)
+  {
+    // The Uno/Mega mapping: 2 and 3 are INT0/INT1, the Mega adds 18-21
+    switch (pin) {
+      case 2:  return 0;
+      case 3:  return 1;
+      case 21: return 2;
+      case 20: return 3;
+      case 19: return 4;
+      case 18: return 5;
+      default: return NOT_AN_INTERRUPT;
+    }
+  }
+
+void attachInterrupt(uint8_t num, void (*fn)(void), int /*mode*/)
+  {
+    if (num < 8) hostHandlers[num] = fn;
+  }
+
+void detachInterrupt(uint8_t num)
+  {
+    if (num < 8) hostHandlers[num] = NULL;
+  }
+
+void noInterrupts(void) {}
+void interrupts(void) {}
+
+// ----- Host Controls -----
+void hostAdvance(unsigned long us)
+  {
+    hostMicros += us;
+  }
+
+void hostPin(uint8_t pin, int level)
+  {
+    hostPins[pin] = level ? HIGH : LOW;
+  }
+
+void hostInterrupt(uint8_t pin)
+  {
+    int num = digitalPinToInterrupt(pin);
+    if (num != NOT_AN_INTERRUPT && hostHandlers[num]) hostHandlers[num]();
+  }
+
+void hostOnYield(void (*fn)(void))
+  {
+    hostYieldFn = fn;
+  }
+
+// ----- Number Conversion (avr-libc) -----
+static char *toText(unsigned long val, bool neg, char *s, int radix)
+  {
+    char tmp[34];
+    int n = 0;
+    do {
+      int d = val % radix;
+      tmp[n++] = (d < 10) ? '0' + d : 'a' + d - 10;
+      val /= radix;
+    } while (val);
+    char *p = s;
+    if (neg) *p++ = '-';
+    while (n) *p++ = tmp[--n];
+    *p = 0;
+    return s;
+  }
+
+char *itoa(int val, char *s, int radix)
+  {
+    if (radix == 10 && val < 0) return toText(-(long)val, true, s, radix);
+    return toText((unsigned int)val, false, s, radix);
+  }
+
+char *utoa(unsigned int val, char *s, int radix)
+  {
+    return toText(val, false, s, radix);
+  }
+
+char *ltoa(long val, char *s, int radix)
+  {
+    if (radix == 10 && val < 0) return toText(-(unsigned long)val, true, s, radix);
+    return toText((unsigned long)val, false, s, radix);
+  }
+
+char *ultoa(unsigned long val, char *s, int radix)
+  {
+    return toText(val, false, s, radix);
+  }
+
+// ----- String -----
+String::String(const char *cstr) : buffer(NULL), capacity(0), len(0)
+  {
+    if (cstr) *this = cstr;
+  }
+
+String::String(const String &str) : buffer(NULL), capacity(0), len(0)
+  {
+    *this = str;
+  }
+
+String::String(const __FlashStringHelper *str) : buffer(NULL), capacity(0), len(0)
+  {
+    *this = (const char *)str;
+  }
+
+String::String(char c) : buffer(NULL), capacity(0), len(0)
+  {
+    char buf[2] = { c, 0 };
+    *this = buf;
+  }
+
+String::String(unsigned char val, unsigned char base) : buffer(NULL), capacity(0), len(0)
+  {
+    char buf[9];
+    *this = utoa(val, buf, base);
+  }
+
+String::String(int val, unsigned char base) : buffer(NULL), capacity(0), len(0)
+  {
+    char buf[34];
+    *this = itoa(val, buf, base);
+  }
+
+String::String(unsigned int val, unsigned char base) : buffer(NULL), capacity(0), len(0)
+  {
+    char buf[33];
+    *this = utoa(val, buf, base);
+  }
+
+String::String(long val, unsigned char base) : buffer(NULL), capacity(0), len(0)
+  {
+    char buf[66];
+    *this = ltoa(val, buf, base);
+  }
+
+String::String(unsigned long val, unsigned char base) : buffer(NULL), capacity(0), len(0)
+  {
+    char buf[65];
+    *this = ultoa(val, buf, base);
+  }
+
+String::~String(void)
+  {
+    free(buffer);
+  }
+
+unsigned char String::changeBuffer(unsigned int size)
+  {
+    // A new block every time (realloc() may or may not move it), so a grown
+    // String always has a new buffer, the same on every host
+    char *p = (char *)malloc(size + 1);
+    if (!p) return 0;
+    if (buffer) memcpy(p, buffer, len + 1);
+    else p[0] = 0;
+    free(buffer);
+    buffer = p;
+    capacity = size;
+    return 1;
+  }
+
+unsigned char String::reserve(unsigned int size)
+  {
+    if (buffer && capacity >= size) return 1;
+    return changeBuffer(size);
+  }
+
+String &String::operator=(const String &rhs)
+  {
+    if (this == &rhs) return *this;
+    return *this = rhs.c_str();
+  }
+
+String &String::operator=(const char *cstr)
+  {
+    unsigned int n = strlen(cstr);
+    if (!reserve(n)) return *this;
+    memmove(buffer, cstr, n + 1);
+    len = n;
+    return *this;
+  }
+
+String &String::operator=(const __FlashStringHelper *str)
+  {
+    return *this = (const char *)str;
+  }
+
+unsigned char String::concat(const char *cstr, unsigned int n)
+  {
+    if (!n) return 1;
+    if (!reserve(len + n)) return 0;
+    memmove(buffer + len, cstr, n);
+    len += n;
+    buffer[len] = 0;
+    return 1;
+  }
+
+String &String::operator+=(const String &rhs)
+  {
+    concat(rhs.c_str(), rhs.length());
+    return *this;
+  }
+
+String &String::operator+=(const char *cstr)
+  {
+    if (cstr) concat(cstr, strlen(cstr));
+    return *this;
+  }
+
+String &String::operator+=(const __FlashStringHelper *str)
+  {
+    return *this += (const char *)str;
+  }
+
+String &String::operator+=(char c)
+  {
+    concat(&c, 1);
+    return *this;
+  }
+
+String &String::operator+=(unsigned char num) { return *this += String(num); }
+String &String::operator+=(int num) { return *this += String(num); }
+String &String::operator+=(unsigned int num) { return *this += String(num); }
+String &String::operator+=(long num) { return *this += String(num); }
+String &String::operator+=(unsigned long num) { return *this += String(num); }
+
+unsigned char String::equals(const char *cstr) const
+  {
+    return strcmp(c_str(), cstr ? cstr : "") == 0;
+  }
+
+char String::charAt(unsigned int index) const
+  {
+    return (index < len) ? buffer[index] : 0;
+  }
+
+int String::indexOf(char c) const
+  {
+    const char *p = strchr(c_str(), c);
+    return (p && c) ? p - c_str() : -1;
+  }
+
+int String::indexOf(const char *str) const
+  {
+    const char *p = strstr(c_str(), str);
+    return p ? p - c_str() : -1;
+  }
+
+long String::toInt(void) const
+  {
+    return atol(c_str());
+  }
+
+void String::toUpperCase(void)
+  {
+    for (unsigned int i=0;i<len;i++) buffer[i] = toupper((unsigned char)buffer[i]);
+  }
+
+String operator+(const String &lhs, const String &rhs)
+  {
+    String s(lhs);
+    s += rhs;
+    return s;
+  }
+
+String operator+(const String &lhs, const char *rhs)
+  {
+    String s(lhs);
+    s += rhs;
+    return s;
+  }
+
+String operator+(const char *lhs, const String &rhs)
+  {
+    String s(lhs);
+    s += rhs;
+    return s;
+  }
+
+String operator+(const String &lhs, const __FlashStringHelper *rhs)
+  {
+    String s(lhs);
+    s += rhs;
+    return s;
+  }
+
+// ----- Print -----
+size_t Print::write(const uint8_t *buf, size_t size)
+  {
+    size_t n = 0;
+    while (size--) {
+      if (!write(*buf++)) break;
+      n++;
+    }
+    return n;
+  }
+
+size_t Print::printNumber(unsigned long num, int base)
+  {
+    char buf[8 * sizeof(long) + 1];
+    if (base < 2) base = 10;
+    return write(ultoa(num, buf, base));
+  }
+
+size_t Print::print(const __FlashStringHelper *str) { return write((const char *)str); }
+size_t Print::print(const String &str) { return write((const uint8_t *)str.c_str(), str.length()); }
+size_t Print::print(const char *str) { return write(str); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char num, int base) { return print((unsigned long)num, base); }
+size_t Print::print(int num, int base) { return print((long)num, base); }
+size_t Print::print(unsigned int num, int base) { return print((unsigned long)num, base); }
+
+size_t Print::print(long num, int base)
+  {
+    if (base == 0) return write((uint8_t)num);
+    if (base == 10 && num < 0) return print('-') + printNumber(-(unsigned long)num, 10);
+    return printNumber(num, base);
+  }
+
+size_t Print::print(unsigned long num, int base)
+  {
+    if (base == 0) return write((uint8_t)num);
+    return printNumber(num, base);
+  }
+
+size_t Print::print(double num, int digits)
+  {
+    // Rounded like the AVR core's printFloat(), which is what %.*f does
+    char buf[48];
+    if (isnan(num)) return print("nan");
+    if (isinf(num)) return print("inf");
+    if (num > 4294967040.0 || num < -4294967040.0) return print("ovf");
+    snprintf(buf, sizeof(buf), "%.*f", digits, num);
+    return print(buf);
+  }
+
+size_t Print::println(void) { return write("\r\n"); }
+size_t Print::println(const __FlashStringHelper *str) { return print(str) + println(); }
+size_t Print::println(const String &str) { return print(str) + println(); }
+size_t Print::println(const char *str) { return print(str) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char num, int base) { return print(num, base) + println(); }
+size_t Print::println(int num, int base) { return print(num, base) + println(); }
+size_t Print::println(unsigned int num, int base) { return print(num, base) + println(); }
+size_t Print::println(long num, int base) { return print(num, base) + println(); }
+size_t Print::println(unsigned long num, int base) { return print(num, base) + println(); }
+size_t Print::println(double num, int digits) { return print(num, digits) + println(); }
+
+// ----- Stream -----
+String Stream::readStringUntil(char terminator)
+  {
+    String s;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) s += (char)c;
+    return s;
+  }
+
+// ----- Serial -----
+size_t HardwareSerial::write(uint8_t c)
+  {
+    if (c != '\r') putchar(c);
+    return 1;
+  }
+
+void HardwareSerial::flush(void)
+  {
+    fflush(stdout);
+  }
@@ -0,0 +1,242 @@
+/* Arduino.h (host shim)
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * The part of the Arduino core that the library and the example sketches use,
+ * so they build and run on the host (Linux) for the tests in host/test. It is
+ * not a board emulation: nothing happens on its own. The test program moves
+ * the time on, sets the pin levels and calls the interrupt handlers with the
+ * host controls at the end of this file.
+ *
+ * String and Print follow the AVR core where the library depends on it: a
+ * String keeps its buffer while the new value fits (reserve() is honoured)
+ * and println() ends lines with "\r\n". Serial writes to stdout without the
+ * "\r", so the output can be compared with text files.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define NOT_AN_INTERRUPT -1
+
+#ifndef min
+#define min(a,b) ((a)<(b)?(a):(b))
+#endif
+#ifndef max
+#define max(a,b) ((a)>(b)?(a):(b))
+#endif
+
+// ----- Flash Strings -----
+// There is only one address space, so PROGMEM data is read in place
+#define PROGMEM
+#define PGM_P const char *
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_ptr(addr)  (*(void * const *)(addr))
+#define strlen_P  strlen
+#define strcpy_P  strcpy
+#define strcmp_P  strcmp
+#define memcpy_P  memcpy
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define FPSTR(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+// ----- Core Functions -----
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t num, void (*fn)(void), int mode);
+void detachInterrupt(uint8_t num);
+void noInterrupts(void);
+void interrupts(void);
+
+char *itoa(int val, char *s, int radix);
+char *utoa(unsigned int val, char *s, int radix);
+char *ltoa(long val, char *s, int radix);
+char *ultoa(unsigned long val, char *s, int radix);
+
+// ----- String -----
+class String
+{
+  public:
+    String(const char *cstr = "");
+    String(const String &str);
+    String(const __FlashStringHelper *str);
+    explicit String(char c);
+    explicit String(unsigned char val, unsigned char base = 10);
+    explicit String(int val, unsigned char base = 10);
+    explicit String(unsigned int val, unsigned char base = 10);
+    explicit String(long val, unsigned char base = 10);
+    explicit String(unsigned long val, unsigned char base = 10);
+    ~String(void);
+
+    // Returns 0 if the memory could not be allocated (the String is unchanged)
+    unsigned char reserve(unsigned int size);
+    unsigned int length(void) const { return len; }
+    const char *c_str(void) const { return buffer ? buffer : ""; }
+
+    String &operator=(const String &rhs);
+    String &operator=(const char *cstr);
+    String &operator=(const __FlashStringHelper *str);
+
+    unsigned char concat(const char *cstr, unsigned int length);
+    String &operator+=(const String &rhs);
+    String &operator+=(const char *cstr);
+    String &operator+=(const __FlashStringHelper *str);
+    String &operator+=(char c);
+    String &operator+=(unsigned char num);
+    String &operator+=(int num);
+    String &operator+=(unsigned int num);
+    String &operator+=(long num);
+    String &operator+=(unsigned long num);
+
+    unsigned char equals(const char *cstr) const;
+    unsigned char operator==(const String &rhs) const { return equals(rhs.c_str()); }
+    unsigned char operator==(const char *cstr) const { return equals(cstr); }
+    unsigned char operator!=(const String &rhs) const { return !equals(rhs.c_str()); }
+    unsigned char operator!=(const char *cstr) const { return !equals(cstr); }
+
+    char charAt(unsigned int index) const;
+    char operator[](unsigned int index) const { return charAt(index); }
+    int indexOf(char c) const;
+    int indexOf(const char *str) const;
+    int indexOf(const String &str) const { return indexOf(str.c_str()); }
+    long toInt(void) const;
+    void toUpperCase(void);
+
+  private:
+    char *buffer;
+    unsigned int capacity;
+    unsigned int len;
+    unsigned char changeBuffer(unsigned int size);
+};
+
+String operator+(const String &lhs, const String &rhs);
+String operator+(const String &lhs, const char *rhs);
+String operator+(const char *lhs, const String &rhs);
+String operator+(const String &lhs, const __FlashStringHelper *rhs);
+
+// ----- Print/Stream -----
+class Print;
+
+class Printable
+{
+  public:
+    virtual ~Printable(void) {}
+    virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print
+{
+  public:
+    virtual ~Print(void) {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buf, size_t size);
+    size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+    size_t write(const char *buf, size_t size) { return write((const uint8_t *)buf, size); }
+    virtual int availableForWrite(void) { return 0; }
+    virtual void flush(void) {}
+
+    size_t print(const __FlashStringHelper *str);
+    size_t print(const String &str);
+    size_t print(const char *str);
+    size_t print(char c);
+    size_t print(unsigned char num, int base = DEC);
+    size_t print(int num, int base = DEC);
+    size_t print(unsigned int num, int base = DEC);
+    size_t print(long num, int base = DEC);
+    size_t print(unsigned long num, int base = DEC);
+    size_t print(double num, int digits = 2);
+    size_t print(const Printable &x) { return x.printTo(*this); }
+
+    size_t println(const __FlashStringHelper *str);
+    size_t println(const String &str);
+    size_t println(const char *str);
+    size_t println(char c);
+    size_t println(unsigned char num, int base = DEC);
+    size_t println(int num, int base = DEC);
+    size_t println(unsigned int num, int base = DEC);
+    size_t println(long num, int base = DEC);
+    size_t println(unsigned long num, int base = DEC);
+    size_t println(double num, int digits = 2);
+    size_t println(const Printable &x) { return print(x) + println(); }
+    size_t println(void);
+
+  private:
+    size_t printNumber(unsigned long num, int base);
+};
+
+class Stream : public Print
+{
+  public:
+    virtual int available(void) = 0;
+    virtual int read(void) = 0;
+    virtual int peek(void) = 0;
+
+    // Reads until "terminator" or no more data (there is no timeout to wait for)
+    String readStringUntil(char terminator);
+};
+
+class HardwareSerial : public Stream
+{
+  public:
+    void begin(unsigned long /*baud*/) {}
+    virtual size_t write(uint8_t c);
+    using Print::write;
+    virtual int available(void) { return 0; }
+    virtual int read(void) { return -1; }
+    virtual int peek(void) { return -1; }
+    virtual void flush(void);
+    operator bool(void) { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// ----- Host Controls (for the test programs) -----
+// Moves micros() (and millis()) on by "us"
+void hostAdvance(unsigned long us);
+
+// Sets the level digitalRead() returns for "pin"
+void hostPin(uint8_t pin, int level);
+
+// Calls the handler attached to the interrupt of "pin", as a pin change would
+void hostInterrupt(uint8_t pin);
+
+// Called by yield(), so a sketch waiting for the bus lets the test move it on
+void hostOnYield(void (*fn)(void));
+
+#endif
@@ -0,0 +1,86 @@
+/* Ethernet.cpp (host shim)
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ */
+
+#include "Ethernet.h"
+
+typedef struct
+{
+  bool open;
+  const char *request;          // Bytes the client sends
+  size_t pos;                   // Next byte of the request to read
+  Print *out;                   // Where the bytes written to the client go
+}
+hostConn_t;
+
+static hostConn_t conns[HOST_CONNS];
+
+EthernetClass Ethernet;
+
+int hostConnect(const char *request, Print &out)
+  {
+    for (byte i=0;i<HOST_CONNS;i++) {
+      if (conns[i].open) continue;
+      conns[i].open = true;
+      conns[i].request = request;
+      conns[i].pos = 0;
+      conns[i].out = &out;
+      return 1;
+    }
+    return 0;                   // return failure (all in use)
+  }
+
+EthernetClient EthernetServer::available(void)
+  {
+    for (byte i=0;i<HOST_CONNS;i++)
+      if (conns[i].open) return EthernetClient(i);
+    return EthernetClient();
+  }
+
+uint8_t EthernetClient::connected(void)
+  {
+    return (conn >= 0 && conns[conn].open);
+  }
+
+size_t EthernetClient::write(uint8_t c)
+  {
+    return write(&c, 1);
+  }
+
+size_t EthernetClient::write(const uint8_t *buf, size_t size)
+  {
+    if (!connected()) return 0;
+    return conns[conn].out->write(buf, size);
+  }
+
+int EthernetClient::available(void)
+  {
+    if (!connected()) return 0;
+    return strlen(conns[conn].request + conns[conn].pos);
+  }
+
+int EthernetClient::read(void)
+  {
+    if (!available()) return -1;
+    return (uint8_t)conns[conn].request[conns[conn].pos++];
+  }
+
+int EthernetClient::read(uint8_t *buf, size_t size)
+  {
+    size_t n = 0;
+    while (n < size && available()) buf[n++] = read();
+    return n ? (int)n : -1;
+  }
+
+int EthernetClient::peek(void)
+  {
+    if (!available()) return -1;
+    return (uint8_t)conns[conn].request[conns[conn].pos];
+  }
+
+void EthernetClient::stop(void)
+  {
+    if (conn >= 0) conns[conn].open = false;
+    conn = -1;
+  }
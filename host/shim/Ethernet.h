@@ -0,0 +1,69 @@
+/* Ethernet.h (host shim)
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * An Ethernet library without a network: DHCP always succeeds, and the clients
+ * the server hands out are the connections a test queued with hostConnect().
+ * Such a client reads the request it was given and its output goes to a Print
+ * of the test.
+ */
+
+#ifndef Ethernet_h
+#define Ethernet_h
+#include "Arduino.h"
+#include "Client.h"
+#include "IPAddress.h"
+
+const byte HOST_CONNS = 4;      // Connections a test can queue
+
+class EthernetClient : public Client
+{
+  public:
+    EthernetClient(void) : conn(-1) {}
+    explicit EthernetClient(int c) : conn(c) {}
+
+    virtual int connect(IPAddress /*ip*/, uint16_t /*port*/) { return 0; }
+    virtual int connect(const char * /*host*/, uint16_t /*port*/) { return 0; }
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t *buf, size_t size);
+    using Print::write;
+    virtual int available(void);
+    virtual int read(void);
+    virtual int read(uint8_t *buf, size_t size);
+    virtual int peek(void);
+    virtual void flush(void) {}
+    virtual void stop(void);
+    virtual uint8_t connected(void);
+    virtual operator bool(void) { return connected(); }
+
+  private:
+    int conn;                   // Index of the host connection, -1 if none
+};
+
+class EthernetServer
+{
+  public:
+    EthernetServer(uint16_t /*port*/) {}
+    void begin(void) {}
+
+    // Returns the oldest open connection, or a client that isn't connected
+    EthernetClient available(void);
+};
+
+class EthernetClass
+{
+  public:
+    int begin(uint8_t * /*mac*/) { return 1; }
+    void begin(uint8_t * /*mac*/, IPAddress /*ip*/) {}
+    IPAddress localIP(void) { return IPAddress(192, 168, 1, 169); }
+};
+
+extern EthernetClass Ethernet;
+
+// ----- Host Controls (for the test programs) -----
+// Queues a client connecting to the server that sends "request" (kept, not
+// copied), what the sketch writes to it goes to "out"
+// Returns:   1 if queued, 0 if HOST_CONNS connections are queued or open
+int hostConnect(const char *request, Print &out);
+
+#endif
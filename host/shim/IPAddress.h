@@ -0,0 +1,32 @@
+/* IPAddress.h (host shim)
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ */
+
+#ifndef IPAddress_h
+#define IPAddress_h
+#include "Arduino.h"
+
+class IPAddress : public Printable
+{
+  public:
+    IPAddress(void) { memset(octets, 0, sizeof(octets)); }
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+      { octets[0] = a; octets[1] = b; octets[2] = c; octets[3] = d; }
+    uint8_t operator[](int index) const { return octets[index]; }
+
+    virtual size_t printTo(Print &p) const
+      {
+        size_t n = 0;
+        for (byte i=0;i<4;i++) {
+          if (i) n += p.print('.');
+          n += p.print(octets[i], DEC);
+        }
+        return n;
+      }
+
+  private:
+    uint8_t octets[4];
+};
+
+#endif
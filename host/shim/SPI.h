@@ -0,0 +1,11 @@
+/* SPI.h (host shim)
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Empty, the Ethernet shim doesn't talk to a controller.
+ */
+
+#ifndef SPI_h
+#define SPI_h
+#include "Arduino.h"
+#endif
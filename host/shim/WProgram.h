@@ -0,0 +1,8 @@
+/* WProgram.h (host shim)
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * The pre 1.0 name of Arduino.h, for the headers that still test ARDUINO.
+ */
+
+#include "Arduino.h"
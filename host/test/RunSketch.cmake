@@ -0,0 +1,21 @@
+# Runs a sketch runner (sketchrun.cpp) over the capture and compares its output
+# with the golden file, for ctest:
+#
+#   cmake -DRUNNER=... -DCAPTURE=... -DGOLDEN=... -DOUTPUT=... [-DARGS=...]
+#         -P RunSketch.cmake
+#
+# ARGS is a ;-list of extra runner arguments (-c). After an intended change of
+# the output, copy OUTPUT (in the build directory) over GOLDEN and review the diff.
+
+execute_process(COMMAND ${RUNNER} ${ARGS} ${CAPTURE}
+                OUTPUT_FILE ${OUTPUT}
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${RUNNER} failed: ${result}")
+endif()
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT} ${GOLDEN}
+                RESULT_VARIABLE differs)
+if(differs)
+  message(FATAL_ERROR "${OUTPUT} differs from ${GOLDEN}")
+endif()
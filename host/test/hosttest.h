@@ -0,0 +1,81 @@
+/* hosttest.h
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Checks and a Keybus feed for the host tests (host/test/test_*.cpp, run by
+ * ctest). A test is a main() with CHECK()s that returns testResult().
+ *
+ * Usage:
+ *    DSC dsc;  dsc.begin();
+ *    busWord(panelBits, "", 500, 6500);   (clock a word into the ISR)
+ *    CHECK(dsc.process() == 1);
+ *    return testResult("gap");
+ */
+
+#ifndef hosttest_h
+#define hosttest_h
+
+#include <stdio.h>
+#include <string>
+
+#include <Arduino.h>
+
+static int testFails = 0;
+
+// Prints the condition and its line if it is false, and counts the failure
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      testFails++; \
+    } \
+  } while (0)
+
+// Prints the result line
+// Returns:   0 if every check passed, 1 if not (the exit status for ctest)
+static inline int testResult(const char *name)
+  {
+    printf("%s: %s\n", name, testFails ? "FAILED" : "passed");
+    return testFails ? 1 : 0;
+  }
+
+const byte TEST_CLK = 3;          // The DSC default pins
+const byte TEST_DTA = 4;
+
+// One clock edge into the ISR, "us" after the last one
+static inline void busEdge(unsigned long us, int clk, int dta)
+  {
+    hostAdvance(us);
+    hostPin(TEST_CLK, clk);
+    hostPin(TEST_DTA, dta);
+    hostInterrupt(TEST_CLK);
+  }
+
+// A panel word as text: the command, the stop bit, the data bytes and the checksum
+static inline std::string panelWord(byte cmd, const byte *data, byte len)
+  {
+    std::string w;
+    byte sum = cmd;
+    for (int b=7;b>=0;b--) w += ((cmd >> b) & 1) ? '1' : '0';
+    w += '0';
+    for (byte i=0;i<=len;i++) {
+      byte d = (i < len) ? data[i] : sum;
+      if (i < len) sum += d;
+      for (int b=7;b>=0;b--) w += ((d >> b) & 1) ? '1' : '0';
+    }
+    return w;
+  }
+
+// Clocks one word into the ISR: the gap, then per bit the falling edge (keypad
+// bit, '1' past the end of "k") and the rising edge (panel bit) "half" us
+// apart, then the next gap and its falling edge, so process() can take the word
+static inline void busWord(const std::string &p, const std::string &k,
+                    unsigned long half, unsigned long gap)
+  {
+    for (size_t i=0;i<p.size();i++) {
+      busEdge(i ? half : gap, 0, (i < k.size()) ? k[i] == '1' : 1);
+      busEdge(half, 1, p[i] == '1');
+    }
+    busEdge(gap, 0, 1);
+  }
+
+#endif
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# Writes the scripted keybus session the sketch tests run over (capture.txt)
+#
+#   mkcapture.py > capture.txt
+#
+# The output is in the "dscrecord.py frames" format, one word per line with the
+# time of its last clock edge in us, so a capture recorded from a panel can be
+# dropped in instead. Idle keypad words (all 1's) are left out to keep the file
+# small, the runner reads a missing keypad word as idle.
+#
+# About 45 s of bus: the panel clock and date, a zone opening and closing, an
+# arm by code with the keypad buttons, an alarm while armed (alarm memory and
+# the panic key), a disarm, the keypad slot query, a new minute, a power
+# failure, then 22 s of the same status word (the sketches' "No data for 20
+# seconds" notice) and a 3 s bus stall.
+
+HALF = 500                  # Clock half period (us)
+GAP = 6500                  # New word gap (us)
+
+KEYS = {"1": 0x82, "2": 0x85, "3": 0x87, "4": 0x88, "#": 0x96}
+PANIC = 0xee
+
+
+def bits(val, n=8):
+    return format(val, "0%db" % n)
+
+
+def panel(cmd, data):
+    """Panel word: command, a 0 bit, the data bytes and the checksum byte."""
+    word = bits(cmd) + "0" + "".join(bits(b) for b in data)
+    return word + bits((cmd + sum(data)) & 0xff)
+
+
+def status(lights=0x81, power_fail=False):
+    return panel(0x05, [lights, 0x01, 0x18 if power_fail else 0x10])
+
+
+def zones(open_zones):
+    return panel(0x27, [0x81, 0x01, 0x91, 0xc7, open_zones])
+
+
+def info(yy, mm, dd, hh, mi, arm=0, user=0):
+    """0xa5: the year as two BCD digits, then month, day, hour and minute."""
+    raw = 0
+    if arm == 0x02:
+        raw = user - 1 + 0x19
+    elif arm == 0x03:
+        raw = user - 1
+    word = bits(0xa5) + "0" + bits(yy // 10, 4) + bits(yy % 10, 4) + "00"
+    word += bits(mm, 4) + bits(dd, 5) + bits(hh, 5) + bits(mi, 6) + "00"
+    word += bits(arm, 2) + bits(raw, 6)
+    data = [int(word[9 + 8 * i:17 + 8 * i], 2) for i in range(5)]
+    return word + bits((0xa5 + sum(data)) & 0xff)
+
+
+def key(name, length):
+    """Keypad button: 0xff, then the button byte, then a bit for the check."""
+    code = KEYS[name]
+    word = bits(0xff) + bits(code)
+    for last in "01":
+        b = int((word + last)[9:17], 2)
+        c = b >> 2
+        if ((c >> 4) + ((c >> 2) & 3) + (c & 3)) & 3 == b & 3:
+            word += last
+            break
+    return (word + "1" * length)[:length]
+
+
+def keypad_cmd(cmd, length):
+    return (bits(cmd) + "1" * length)[:length]
+
+
+def slots(present, length):
+    """Reply to the 0x11 query, two bits per slot, 11 for an empty slot."""
+    word = bits(0xff) + "1"
+    for i in range(8):
+        word += "00" if (i + 1) in present else "11"
+    return (word + "1" * length)[:length]
+
+
+class Session:
+    def __init__(self):
+        self.t = 0
+        self.lines = []
+        self.count = 0
+        self.light = status()
+
+    def word(self, p, k=None):
+        n = len(p)
+        self.t += GAP + (2 * n - 1) * HALF
+        self.lines.append("P %s %d" % (p, self.t))
+        if k is not None:
+            self.lines.append("K %s %d" % (k, self.t))
+        self.t += HALF
+        self.count += 1
+
+    def idle(self, seconds, zone_word=None):
+        """Status words (and the zone word every 40th) for about "seconds"."""
+        end = self.t + seconds * 1000000
+        while self.t < end:
+            if zone_word and self.count % 40 == 0:
+                self.word(zone_word)
+            else:
+                self.word(self.light)
+
+    def press(self, names, zone_word):
+        for name in names:
+            self.word(self.light, key(name, len(self.light)))
+            self.idle(0.3, zone_word)
+
+    def stall(self, seconds):
+        self.t += int(seconds * 1000000)
+
+
+def main():
+    s = Session()
+    z = zones(0x00)
+    s.word(info(26, 10, 18, 21, 30))
+    s.idle(2, z)
+
+    # Zone 1 opens and closes
+    z = zones(0x01)
+    s.light = status(0x80)
+    s.word(z)
+    s.idle(1.5, z)
+    z = zones(0x00)
+    s.light = status(0x81)
+    s.word(z)
+    s.idle(1.5, z)
+
+    # Armed by user 1, exit delay beeps
+    s.press("1234", z)
+    s.word(info(26, 10, 18, 21, 30, arm=0x02, user=1))
+    s.light = status(0x82)
+    s.word(panel(0x64, [0x06]))
+    s.idle(1.5, z)
+
+    # Zone 2 opens while armed: alarm memory, then the panic key
+    z = zones(0x02)
+    s.word(z)
+    s.word(panel(0x5d, [0x02, 0x00, 0x00, 0x00, 0x00]))
+    s.light = status(0x86)
+    s.idle(1, z)
+    s.word(s.light, keypad_cmd(PANIC, len(s.light)))
+    s.idle(1, z)
+
+    # Disarmed by user 1, the zone closes (alarm memory stays on)
+    s.press("1234", z)
+    s.word(info(26, 10, 18, 21, 30, arm=0x03, user=1))
+    s.light = status(0x84)
+    s.idle(1, z)
+    z = zones(0x00)
+    s.light = status(0x85)
+    s.word(z)
+    s.idle(1, z)
+
+    # Keypad slot query, answered by the keypads in slots 1 and 2
+    q = panel(0x11, [0xaa, 0xaa, 0xaa, 0xaa])
+    s.word(q, slots({1, 2}, len(q)))
+    s.idle(1, z)
+
+    # A new minute, then a power failure and the power back
+    s.word(info(26, 10, 18, 21, 31))
+    s.idle(1, z)
+    s.light = status(0x85, power_fail=True)
+    s.idle(1.5, z)
+    s.light = status(0x85)
+
+    # Nothing new for 22 s, then the bus stops for 3 s
+    s.idle(22)
+    s.stall(3)
+    s.word(z)
+    s.idle(2, z)
+
+    print("\n".join(s.lines))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,36 @@
+/* sketch.h
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * The function prototypes the Arduino IDE generates for the example sketches,
+ * for building them as C++ (sketchrun.cpp). Every function of every example is
+ * declared, a sketch only defines its own.
+ */
+
+#ifndef sketch_h
+#define sketch_h
+#include <Arduino.h>
+#include <TimeLib.h>
+#include <DSC_Events.h>
+#include <DSC_Diag.h>
+#include <DSC_Scheduler.h>
+
+void setup();
+void loop();
+
+const char* formatTime(time_t cTime);
+String digits(unsigned int val);
+void setDscTime();
+
+void clientTask();
+void watchdogTask();
+void decodeTask();
+void netTask();
+void syncTask();
+void memoryTask();
+void reportTask();
+void alarmFound(const dscEvent_t &evt);
+void memoryGuard(byte flags, const dscMem_t &m);
+void taskReport(byte task, const dscTask_t &t, byte reason);
+
+#endif
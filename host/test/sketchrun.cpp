@@ -0,0 +1,237 @@
+/* sketchrun.cpp
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * Runs an example sketch on the host shim (host/shim) over a recorded Keybus
+ * capture, for the golden output tests (host/test/golden, RunSketch.cmake).
+ *
+ *    sketchrun [-c ms path]... [-t timing.txt] capture.txt > output.txt
+ *
+ * The sketch is built in with -DSKETCH="path/to/Sketch.ino", one runner per
+ * sketch. The capture has one word per line as printed by "dscrecord.py frames"
+ * ("P <bits> <time_us>", "K <bits> <time_us>", the time of the last clock edge
+ * of the word); a panel word without a keypad word has the keypad line idle.
+ * The runner turns the words back into clock edges (HALF_US apart, the panel
+ * bit on the rising edge, the keypad bit on the falling edge) and calls the
+ * clock interrupt for each one, with loop() run at least every ms of bus time.
+ * A sketch waiting in dsc.idle() moves the bus on through yield().
+ *
+ * Serial goes to stdout. "-c" connects a network client "ms" into the run that
+ * requests "path" (as "GET <path> HTTP/1.1"), what the sketch sends it is
+ * printed after the run. The time the host took per frame (from the first edge
+ * of a word to the first edge of the next, loop() included) goes to stderr as
+ * min/avg/max, and one line per frame to "-t" ("<time_us> <cmd> <host_us>").
+ */
+
+// The C++ headers first, Arduino.h defines min() and max() as macros
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "sketch.h"
+#include SKETCH
+
+#include <Ethernet.h>
+
+namespace run {
+
+const unsigned long HALF_US = 500;      // Clock half period of the rebuilt edges
+const unsigned long TAIL_US = 2000000;  // Run on after the last edge (timeouts)
+const byte CLK_PIN = 3;                 // The sketches' dsc.setCLK(3)
+const byte DTA_PIN = 4;                 // The DSC default data in pin
+
+struct Edge
+  {
+    unsigned long t;
+    byte clk, dta;
+    bool first;                         // First edge of a word (ends the gap)
+    byte cmd;                           // Panel command of that word
+  };
+
+// A network client: its request and what the sketch sent it
+struct Conn : public Print
+  {
+    unsigned long at;                   // Connects at this micros()
+    bool queued;                        // Connected (conns doesn't grow after that)
+    std::string path, request, text;
+
+    virtual size_t write(uint8_t c)
+      {
+        text += (char)c;
+        return 1;
+      }
+    using Print::write;
+  };
+
+static std::vector<Edge> edges;
+static size_t next = 0;
+static std::vector<Conn> conns;
+
+typedef std::chrono::steady_clock Clock;
+static Clock::time_point frameStart;
+static long lastEdge = -1;              // Index of the last first edge timed
+static std::vector<double> frameUs;
+static FILE *timing = NULL;
+
+static void usage(void)
+  {
+    fprintf(stderr, "usage: sketchrun [-c ms path]... [-t timing.txt] capture.txt\n");
+    exit(2);
+  }
+
+// Adds the edges of one word that ends (last rising edge) at "end"
+static void addWord(const std::string &p, const std::string &k, unsigned long end)
+  {
+    unsigned long n = p.size();
+    unsigned long t = end - (2 * n - 1) * HALF_US;
+    byte cmd = 0;
+    for (unsigned long i=0;i<8 && i<n;i++) cmd = (cmd << 1) | (p[i] == '1');
+    for (unsigned long i=0;i<n;i++) {
+      Edge fall = { t, 0, (byte)(i < k.size() ? k[i] == '1' : 1), i == 0, cmd };
+      Edge rise = { t + HALF_US, 1, (byte)(p[i] == '1'), false, 0 };
+      edges.push_back(fall);
+      edges.push_back(rise);
+      t += 2 * HALF_US;
+    }
+  }
+
+static void readCapture(const char *path)
+  {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+      perror(path);
+      exit(1);
+    }
+    // Panel word waiting for its keypad word (same time), added on the next line
+    std::string p, k;
+    unsigned long end = 0;
+    bool pending = false;
+    char line[512], bits[400];
+    unsigned long t;
+    char src;
+    while (fgets(line, sizeof(line), f)) {
+      if (sscanf(line, "%c %399s %lu", &src, bits, &t) != 3) continue;
+      if (src == 'K' && pending && t == end) {
+        k = bits;
+        continue;
+      }
+      if (src != 'P') continue;
+      if (pending) addWord(p, k, end);
+      p = bits;
+      k.clear();
+      end = t;
+      pending = true;
+    }
+    if (pending) addWord(p, k, end);
+    fclose(f);
+
+    // The last word ends with the next gap, the falling edge of a word that isn't there
+    if (!edges.empty()) {
+      Edge close = { edges.back().t + 6500, 0, 1, true, 0 };
+      edges.push_back(close);
+    }
+  }
+
+static void timeFrame(void)
+  {
+    Clock::time_point now = Clock::now();
+    if (lastEdge >= 0) {
+      double us = std::chrono::duration<double, std::micro>(now - frameStart).count();
+      frameUs.push_back(us);
+      if (timing) fprintf(timing, "%lu %02x %.1f\n", edges[lastEdge].t, edges[lastEdge].cmd, us);
+    }
+    frameStart = now;
+    lastEdge = next;
+  }
+
+// Moves the bus on: to the next edge if it is within 1 ms, otherwise by 1 ms
+static void step(void)
+  {
+    unsigned long now = micros();
+    for (auto &c : conns) {
+      if (!c.queued && now >= c.at) {
+        if (!hostConnect(c.request.c_str(), c))
+          fprintf(stderr, "sketchrun: no free connection for %s\n", c.path.c_str());
+        c.queued = true;
+      }
+    }
+    if (next >= edges.size() || edges[next].t > now + 1000) {
+      hostAdvance(1000);
+      return;
+    }
+    const Edge &e = edges[next];
+    if (e.t > now) hostAdvance(e.t - now);
+    if (e.first) timeFrame();
+    hostPin(CLK_PIN, e.clk);
+    hostPin(DTA_PIN, e.dta);
+    hostInterrupt(CLK_PIN);
+    next++;
+  }
+
+static void report(void)
+  {
+    if (frameUs.empty()) return;
+    double lo = frameUs[0], hi = frameUs[0], sum = 0;
+    for (double us : frameUs) {
+      if (us < lo) lo = us;
+      if (us > hi) hi = us;
+      sum += us;
+    }
+    fprintf(stderr, "sketchrun: %zu frames, host time per frame min %.1f avg %.1f max %.1f us\n",
+            frameUs.size(), lo, sum / frameUs.size(), hi);
+  }
+
+} // namespace run
+
+int main(int argc, char **argv)
+  {
+    int opt;
+    while ((opt = getopt(argc, argv, "c:t:")) != -1) {
+      if (opt == 'c') {
+        if (optind >= argc) run::usage();
+        run::Conn c;
+        c.at = strtoul(optarg, NULL, 10) * 1000;
+        c.queued = false;
+        c.path = argv[optind++];
+        c.request = "GET " + c.path + " HTTP/1.1\r\n\r\n";
+        run::conns.push_back(c);
+      }
+      else if (opt == 't') {
+        run::timing = fopen(optarg, "w");
+        if (!run::timing) {
+          perror(optarg);
+          return 1;
+        }
+      }
+      else run::usage();
+    }
+    if (optind != argc - 1) run::usage();
+    run::readCapture(argv[optind]);
+    if (run::edges.empty()) {
+      fprintf(stderr, "sketchrun: no words in %s\n", argv[optind]);
+      return 1;
+    }
+
+    hostOnYield(run::step);
+    setup();
+    unsigned long end = run::edges.back().t + run::TAIL_US;
+    while (micros() < end) {
+      run::step();
+      loop();
+    }
+    Serial.flush();
+
+    for (auto &c : run::conns) {
+      printf("\n--- Client %s ---\n", c.path.c_str());
+      for (char ch : c.text) if (ch != '\r') putchar(ch);
+    }
+    fflush(stdout);
+    run::report();
+    if (run::timing) fclose(run::timing);
+    return 0;
+  }
@@ -0,0 +1,87 @@
+/* test_anomaly.cpp
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * The timing anomaly detector (DSC_Anomaly.h) learns its baseline from the
+ * word timing the ISR collects, then flags nothing on a normal bus, and the
+ * rate, stall and short flags on a faster clock, a long gap and a clock held
+ * high.
+ */
+
+#include "hosttest.h"
+#include <DSC.h>
+#include <DSC_Anomaly.h>
+
+static const std::string status = "00000101" "0" "10000001" "00000001" "00010000" "10010111";
+
+DSC dsc;
+DSCAnomaly anomaly;
+
+// Text of printFlags()
+class FlagText : public Print
+{
+  public:
+    String text;
+    virtual size_t write(uint8_t c) { text += (char)c; return 1; }
+    using Print::write;
+};
+
+// Sends a word and returns the flags of its timing
+static byte word(unsigned long half, unsigned long gap)
+  {
+    busWord(status, "", half, gap);
+    dsc.process();
+    dscTiming_t t;
+    CHECK(dsc.frameTiming(t));
+    CHECK(t.edges == 2 * status.size() - 1);
+    return anomaly.update(t);
+  }
+
+static String flagText(byte flags)
+  {
+    FlagText out;
+    anomaly.printFlags(out, flags);
+    return out.text;
+  }
+
+int main(void)
+  {
+    CHECK(dsc.begin());
+
+    // ----- Learning -----
+    for (byte i=0;i<ANOM_LEARN_WORDS;i++) CHECK(word(500, 6500) == 0);
+    CHECK(anomaly.learned());
+
+    // ----- Normal bus -----
+    byte flags = 0;
+    for (int i=0;i<100;i++) flags |= word(500, 6500);
+    CHECK(flags == 0);
+    CHECK(flagText(flags) == "None");
+
+    // ----- Faster clock (0.35 ms half periods, 30% off) -----
+    flags = word(350, 6500);
+    CHECK(flags & ANOM_RATE);
+    CHECK(anomaly.count[6] == 1);               // count[i] is for the flag (1 << i)
+    CHECK(flagText(ANOM_RATE) == "Rate");
+    CHECK(word(500, 6500) == 0);                // The baseline didn't move
+
+    // ----- Clock stall: a 100 ms gap, then no words at all -----
+    flags = word(500, 100000);
+    CHECK(flags & ANOM_STALL);
+    CHECK(flags & ANOM_GAP);
+    CHECK(anomaly.stalled() == 0);
+    hostAdvance((ANOM_STALL_MS + 1) * 1000UL);
+    CHECK(anomaly.stalled() == ANOM_STALL);
+
+    // ----- Bus short: the clock held high through the word -----
+    dscTiming_t t;
+    CHECK(dsc.frameTiming(t) == 0);             // Nothing new since the last word
+    word(500, 6500);
+    dsc.frameTiming(t);
+    t.highTime = t.sumIntv;
+    flags = anomaly.update(t);
+    CHECK(flags & ANOM_SHORT);
+    CHECK(flagText(ANOM_SHORT | ANOM_RATE) == "Short, Rate");
+
+    return testResult("anomaly");
+  }
@@ -0,0 +1,52 @@
+/* test_gap.cpp
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * The new word gap threshold (dscGap_t) is learned from the bus and stays put
+ * when the bus stalls: 2 s gaps between the words don't pull it up, and every
+ * word is still taken.
+ */
+
+#include "hosttest.h"
+#include <DSC.h>
+
+static const std::string status = "00000101" "0" "10000001" "00000001" "00010000" "10010111";
+static const std::string zones = "00100111" "0" "10000001" "00000001" "10010001" "11000111" "00000001" "00000010";
+
+DSC dsc;
+
+int main(void)
+  {
+    CHECK(dsc.begin());
+    dscGap_t g;
+    CHECK(!dsc.gapTiming(g));                   // Nothing learned yet
+
+    // ----- Learning: 0.5 ms half periods, 6.5 ms gaps -----
+    int taken = 0;
+    for (int i=0;i<60;i++) {
+      busWord((i & 1) ? zones : status, "", 500, 6500);
+      if (dsc.process() & 1) taken++;
+    }
+    CHECK(dsc.gapTiming(g));
+    CHECK(g.state == GAP_TRACK);
+    CHECK(g.maxBit >= 500 && g.maxBit < 600);
+    CHECK(g.minGap >= 6000 && g.minGap <= 6500);
+    CHECK(g.thresh > 1000 && g.thresh < 6000);
+    CHECK(taken == 60);
+    unsigned long learned = g.thresh;
+
+    // ----- Stalls: every other word after a 2 s gap -----
+    taken = 0;
+    for (int i=0;i<400;i++) {
+      busWord((i & 2) ? zones : status, "", 500, (i & 1) ? 2000000 : 6500);
+      if (dsc.process() & 1) taken++;
+    }
+    CHECK(dsc.gapTiming(g));
+    CHECK(g.thresh <= learned + learned / 4);   // The stalls are left out
+    CHECK(g.minGap <= 6500);
+    CHECK(g.relearns == 0);
+    CHECK(taken == 200);                        // Every change of word (duplicates aren't decoded)
+
+    printf("gap: threshold %lu us, half period %u us, gap %lu us\n", g.thresh, g.maxBit, g.minGap);
+    return testResult("gap");
+  }
@@ -0,0 +1,320 @@
+/* test_json.cpp
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * The JSON encoder (DSC_Json.h): the objects written for the words clocked into
+ * the DSC ISR are read back with a strict JSON parser (RFC 8259, below) and
+ * their members checked, escaping included. Then a benchmark of the encoder
+ * alone, in bytes per us of host time.
+ */
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include "hosttest.h"
+#include <DSC.h>
+#include <DSC_Json.h>
+
+static const std::string status = "00000101" "0" "10000001" "00000001" "00010000" "10010111";
+static const std::string powerFail = "00000101" "0" "10000001" "00000001" "00011000" "10011111";
+static const std::string zones13 = "00100111" "0" "10000001" "00000001" "10010001" "11000111" "00000101" "00000110";
+static const std::string armed = "10100101" "0" "00100110" "00101010" "01010101" "01111000" "10011001" "01011011";
+static const std::string panicKey = "11101110";
+
+const int BENCH_WORDS = 20000;
+
+// ----- JSON parser -----
+struct Json
+  {
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } type = NUL;
+    bool b = false;
+    double num = 0;
+    std::string str;
+    std::vector<Json> items;
+    std::map<std::string, Json> members;
+
+    const Json &operator[](const char *name) const
+      {
+        static const Json none;
+        auto m = members.find(name);
+        return (m == members.end()) ? none : m->second;
+      }
+  };
+
+class JsonParser
+{
+  public:
+    // Parses "text", one value with nothing but white space around it
+    // Returns:   1 if the text is valid JSON, 0 if not
+    int parse(const std::string &text, Json &v)
+      {
+        s = text.c_str();
+        end = s + text.size();
+        ok = true;
+        space();
+        value(v, 0);
+        space();
+        return ok && s == end;
+      }
+
+  private:
+    const char *s, *end;
+    bool ok;
+
+    void fail(void) { ok = false; s = end; }
+    void space(void) { while (s < end && (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r')) s++; }
+    bool literal(const char *word)
+      {
+        size_t n = strlen(word);
+        if ((size_t)(end - s) < n || strncmp(s, word, n)) return false;
+        s += n;
+        return true;
+      }
+
+    void value(Json &v, int depth)
+      {
+        if (!ok || s >= end || depth > 32) return fail();
+        if (*s == '{') {
+          v.type = Json::OBJECT;
+          s++; space();
+          if (s < end && *s == '}') { s++; return; }
+          for (;;) {
+            Json k;
+            if (s >= end || *s != '"') return fail();
+            string(k.str);
+            space();
+            if (s >= end || *s != ':') return fail();
+            s++; space();
+            if (v.members.count(k.str)) return fail();      // Duplicate key
+            value(v.members[k.str], depth + 1);
+            space();
+            if (s < end && *s == ',') { s++; space(); continue; }
+            if (s < end && *s == '}') { s++; return; }
+            return fail();
+          }
+        }
+        if (*s == '[') {
+          v.type = Json::ARRAY;
+          s++; space();
+          if (s < end && *s == ']') { s++; return; }
+          for (;;) {
+            v.items.push_back(Json());
+            value(v.items.back(), depth + 1);
+            space();
+            if (s < end && *s == ',') { s++; space(); continue; }
+            if (s < end && *s == ']') { s++; return; }
+            return fail();
+          }
+        }
+        if (*s == '"') { v.type = Json::STRING; return string(v.str); }
+        if (literal("true")) { v.type = Json::BOOL; v.b = true; return; }
+        if (literal("false")) { v.type = Json::BOOL; return; }
+        if (literal("null")) return;
+        number(v);
+      }
+
+    void string(std::string &out)
+      {
+        s++;
+        while (s < end && *s != '"') {
+          unsigned char c = *s++;
+          if (c < 0x20) return fail();                      // Must be escaped
+          if (c != '\\') { out += c; continue; }
+          if (s >= end) return fail();
+          c = *s++;
+          switch (c) {
+            case '"': case '\\': case '/': out += c; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+              if (end - s < 4) return fail();
+              unsigned int u = 0;
+              for (int i=0;i<4;i++) {
+                char h = *s++;
+                if (!isxdigit(h)) return fail();
+                u = u * 16 + (isdigit(h) ? h - '0' : (tolower(h) - 'a' + 10));
+              }
+              if (u > 0x7f) return fail();                  // The encoder only writes ASCII
+              out += (char)u;
+              break;
+            }
+            default: return fail();
+          }
+        }
+        if (s >= end) return fail();
+        s++;
+      }
+
+    void number(Json &v)
+      {
+        // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+        const char *start = s;
+        if (s < end && *s == '-') s++;
+        if (s >= end || !isdigit(*s)) return fail();
+        if (*s == '0') s++;
+        else while (s < end && isdigit(*s)) s++;
+        if (s < end && *s == '.') {
+          s++;
+          if (s >= end || !isdigit(*s)) return fail();
+          while (s < end && isdigit(*s)) s++;
+        }
+        if (s < end && (*s == 'e' || *s == 'E')) {
+          s++;
+          if (s < end && (*s == '+' || *s == '-')) s++;
+          if (s >= end || !isdigit(*s)) return fail();
+          while (s < end && isdigit(*s)) s++;
+        }
+        v.type = Json::NUMBER;
+        v.num = strtod(std::string(start, s - start).c_str(), NULL);
+      }
+};
+
+// ----- Outputs -----
+class Capture : public Print
+{
+  public:
+    std::string text;
+    virtual size_t write(uint8_t c) { text += (char)c; return 1; }
+    using Print::write;
+};
+
+class Discard : public Print
+{
+  public:
+    unsigned long bytes = 0;
+    virtual size_t write(uint8_t /*c*/) { bytes++; return 1; }
+    virtual size_t write(const uint8_t * /*buf*/, size_t size) { bytes += size; return size; }
+};
+
+DSC dsc;
+Capture out;
+DSCJson json(out);
+JsonParser parser;
+
+// Sends a word and parses the JSON line written for it
+// Returns:   the object, or a null value if nothing or no valid JSON was written
+static Json encode(const std::string &p, const std::string &k, bool keypad)
+  {
+    busWord(p, k, 500, 6500);
+    CHECK(dsc.process());
+    out.text = "";
+    unsigned long before = json.byteCount;
+    CHECK(keypad ? json.keypad(dsc) : json.panel(dsc));
+    CHECK(json.byteCount - before == out.text.size());
+    CHECK(out.text.size() >= 2 && out.text.compare(out.text.size() - 2, 2, "\r\n") == 0);
+    CHECK(out.text.find('\n') == out.text.size() - 1);    // One object per line
+    Json v;
+    if (!parser.parse(out.text, v)) {
+      fprintf(stderr, "not valid JSON: %s", out.text.c_str());
+      CHECK(0);
+      return Json();
+    }
+    CHECK(v.type == Json::OBJECT);
+    return v;
+  }
+
+int main(void)
+  {
+    CHECK(dsc.begin());
+
+    // ----- Parser self check -----
+    Json v;
+    CHECK(parser.parse("{\"a\":[1,-2.5e3,true,null],\"b\":\"\\u0041\"}", v));
+    CHECK(v["b"].str == "A" && v["a"].items.size() == 4);
+    CHECK(!parser.parse("{\"a\":1,}", v));
+    CHECK(!parser.parse("{\"a\":1}{", v));
+    CHECK(!parser.parse("[01]", v));
+    CHECK(!parser.parse("\"\t\"", v));
+
+    // ----- Status with a power failure -----
+    v = encode(powerFail, "", false);
+    CHECK(v["src"].str == "panel");
+    CHECK(v["cmd"].type == Json::NUMBER && v["cmd"].num == 5);
+    CHECK(v["bytes"].str == "05 81 01 18 9f");
+    CHECK(v["msg"].type == Json::STRING && v["msg"].str == dsc.dscGlobal.pMsg.c_str());
+    CHECK(v["crc"].type == Json::BOOL && v["crc"].b);
+    const Json &st = v["status"];
+    CHECK(st.type == Json::OBJECT && st.members.size() == 7);
+    CHECK(st["ready"].b);
+    CHECK(!st["armed"].b);
+    CHECK(st["powerFail"].type == Json::BOOL && st["powerFail"].b);
+    CHECK(st["power"].type == Json::NUL);                 // Renamed, the flag is a failure
+    v = encode(status, "", false);
+    CHECK(v["status"]["powerFail"].type == Json::BOOL && !v["status"]["powerFail"].b);
+
+    // ----- Open zones -----
+    v = encode(zones13, "", false);
+    CHECK(v["cmd"].num == 0x27);
+    CHECK(v["zones"].type == Json::ARRAY && v["zones"].items.size() == 2);
+    if (v["zones"].items.size() == 2)
+      CHECK(v["zones"].items[0].num == 1 && v["zones"].items[1].num == 3);
+    CHECK(v["status"].type == Json::NUL);
+
+    // ----- Armed, with the panel time -----
+    v = encode(armed, "", false);
+    CHECK(v["cmd"].num == 0xa5);
+    CHECK(v["arm"].str == "armed");
+    CHECK(v["user"].num == 1);
+    if (dsc.timeAvailable) {
+      CHECK(v["time"].type == Json::OBJECT);
+      CHECK(v["time"]["y"].num == dsc.yy + 2000);
+      CHECK(v["time"]["M"].num == dsc.MM);
+    }
+    else CHECK(v["time"].type == Json::NUL);
+
+    // ----- Keypad panic -----
+    v = encode(status, panicKey, true);
+    CHECK(v["src"].str == "keypad");
+    CHECK(v["cmd"].num == 0xee);
+    CHECK(v["bytes"].str == "ee ff ff ff ff");            // Idle (1) bits after the key
+    CHECK(v["alarm"].str == "panic");
+    CHECK(json.panel(dsc));                               // Same word period, both sides
+    CHECK(json.keypad(dsc));
+
+    // ----- Escaping, low level calls -----
+    out.text = "";
+    json.beginObject();
+    json.key("text");   json.value("say \"hi\"\\\n\t\x01");
+    json.key("list");
+    json.beginArray();
+    json.value(F("a")); json.value(String("b")); json.value(-7L);
+    json.beginObject(); json.endObject();
+    json.endArray();
+    json.endObject();
+    CHECK(parser.parse(out.text, v));
+    CHECK(v["text"].str == "say \"hi\"\\\n\t\x01");
+    CHECK(v["list"].items.size() == 4);
+    CHECK(out.text.find('\n') == std::string::npos);      // Control characters escaped
+
+    // ----- No word -----
+    dsc.dscGlobal.pCmd = 0;
+    dsc.dscGlobal.kCmd = 0;
+    out.text = "";
+    CHECK(json.panel(dsc) == 0);
+    CHECK(json.keypad(dsc) == 0);
+    CHECK(out.text.empty());
+
+    // ----- Benchmark: the encoder alone, on the four kinds of words -----
+    Discard sink;
+    DSCJson bench(sink);
+    const std::string *words[] = { &status, &zones13, &armed, &powerFail };
+    double us = 0;
+    for (int w=0;w<4;w++) {
+      busWord(*words[w], (w == 0) ? panicKey : "", 500, 6500);
+      dsc.process();
+      auto start = std::chrono::steady_clock::now();
+      for (int i=0;i<BENCH_WORDS/4;i++) {
+        bench.panel(dsc);
+        if (w == 0) bench.keypad(dsc);
+      }
+      us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+    CHECK(bench.byteCount == sink.bytes);
+    printf("json: %lu bytes in %.0f us, %.1f bytes/us (%d words)\n",
+           sink.bytes, us, us > 0 ? sink.bytes / us : 0.0, BENCH_WORDS);
+    return testResult("json");
+  }
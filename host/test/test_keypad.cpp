@@ -0,0 +1,121 @@
+/* test_keypad.cpp
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * The keypad button check and the keypad slot reply (DSC_Core.h), clocked into
+ * the DSC ISR: every button code of dscKeyCode[] is decoded with its check
+ * bits and rejected (kInvalid) without them, the right arrow is decoded with
+ * either check bit, and the reply to the 0x11 slot query gives the keypads
+ * present.
+ */
+
+#include "hosttest.h"
+#include <DSC.h>
+#include <DSC_Strings.h>
+
+static const std::string status = "00000101" "0" "10000001" "00000001" "00010000" "10010111";
+static const byte query[] = { 0xaa, 0xaa, 0xaa, 0xaa };
+
+DSC dsc;
+
+static std::string bits(byte b)
+  {
+    std::string w;
+    for (int i=7;i>=0;i--) w += ((b >> i) & 1) ? '1' : '0';
+    return w;
+  }
+
+// A button word: kOut, the button code, then the bit that completes the check
+// (bits 9-16). Returns the word with the other bit if "good" is false
+static std::string keyWord(byte code, bool good)
+  {
+    std::string w = bits(kOut) + bits(code);
+    byte last = dscKeyCheck(((code << 1) | 1) & 0xff) ? 1 : 0;
+    if (!good) last ^= 1;
+    return w + (last ? '1' : '0');
+  }
+
+// A reply to the slot query, 2 bits per slot from bit 9, 11 for an empty slot
+static std::string slotWord(byte present)
+  {
+    std::string w = bits(kOut) + "1";
+    for (byte i=0;i<KPD_SLOT_COUNT;i++) w += (present & (1 << i)) ? "00" : "11";
+    return w;
+  }
+
+// Sends a panel word and a keypad word in the same period
+// Returns:   1 if the keypad word was decoded, 0 if not
+static int send(const std::string &p, const std::string &k)
+  {
+    busWord(p, k, 500, 6500);
+    return (dsc.process() & 2) ? 1 : 0;
+  }
+
+int main(void)
+  {
+    CHECK(dsc.begin());
+
+    // ----- Every button of the table -----
+    for (byte key=0;key<KEY_BUTTONS;key++) {
+      byte code = dscKeyCode[key];
+      String expect = dscStr(STR_BUTTON);
+      expect += dscStr(STR_KEY_1 + key);
+      unsigned int invalid = dsc.dscGlobal.kInvalid;
+      int taken = send(status, keyWord(code, true));
+      CHECK(taken);
+      CHECK(dsc.dscGlobal.kMsg == expect);
+      if (!taken || dsc.dscGlobal.kMsg != expect) fprintf(stderr, "  key %d (0x%02x)\n", key, code);
+      CHECK(dsc.dscGlobal.kInvalid == invalid);
+
+      // The other check bit: rejected, except for the right arrow
+      taken = send(status, keyWord(code, false));
+      if (code == rArrow) {
+        CHECK(taken);
+        CHECK(dsc.dscGlobal.kMsg == expect);
+        CHECK(dsc.dscGlobal.kInvalid == invalid);
+      }
+      else {
+        CHECK(!taken);
+        CHECK(dsc.dscGlobal.kInvalid == invalid + 1);
+        if (taken) fprintf(stderr, "  key %d (0x%02x) taken without its check\n", key, code);
+      }
+    }
+
+    // ----- Not a button: a code that passes the check but isn't in the table -----
+    CHECK(dscKeyCheck(0x00));
+    CHECK(send(status, bits(kOut) + "000000000"));
+    String unknown = dscStr(STR_KEYPAD_HEX);
+    unknown += "00";
+    unknown += dscStr(STR_UNKNOWN);
+    CHECK(dsc.dscGlobal.kMsg == unknown);
+
+    // ----- Fire, aux and panic: the 1st byte, no check -----
+    const byte alarms[] = { fire, aux, panic };
+    for (byte i=0;i<3;i++) {
+      String expect = dscStr(STR_BUTTON);
+      expect += dscStr(STR_KEY_FIRE + i);
+      CHECK(send(status, bits(alarms[i])));
+      CHECK(dsc.dscGlobal.kMsg == expect);
+    }
+
+    // ----- Slot query [0x11] -----
+    std::string q = panelWord(0x11, query, sizeof(query));
+    CHECK(send(q, slotWord(0x03)));
+    CHECK(dsc.dscGlobal.kSlots == 0x03);
+    String expect = dscStr(STR_KEYPAD_SLOTS);
+    expect += "1 2 ";
+    CHECK(dsc.dscGlobal.kMsg == expect);
+    CHECK(send(q, slotWord(0x84)));
+    CHECK(dsc.dscGlobal.kSlots == 0x84);                // Slots 3 and 8
+    CHECK(send(q, slotWord(0xff)));
+    CHECK(dsc.dscGlobal.kSlots == 0xff);
+    CHECK(!send(q, slotWord(0x00)));                    // All 1's, no keypad answered
+
+    // The same reply to another command is not a slot reply
+    dsc.dscGlobal.kSlots = 0;
+    send(status, slotWord(0x03));
+    CHECK(dsc.dscGlobal.kSlots == 0);
+
+    printf("keypad: %d buttons, %u words rejected\n", KEY_BUTTONS, dsc.dscGlobal.kInvalid);
+    return testResult("keypad");
+  }
@@ -0,0 +1,70 @@
+/* test_model.cpp
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * The panel model profile (DSC_Config.h), built once per model with the
+ * decoder core (CMakeLists.txt, model_1816/1832/1864): the zone groups the model
+ * decodes, the word buffer sizes, and the zone words of the groups it can't
+ * have left undecoded.
+ */
+
+#include "hosttest.h"
+#include <DSC_Core.h>
+
+#if DSC_PANEL == 1816
+const byte expectZones = 16, expectGroups = 2, expectMaxBits = 96;
+#elif DSC_PANEL == 1832
+const byte expectZones = 32, expectGroups = 4, expectMaxBits = 128;
+#else
+const byte expectZones = 64, expectGroups = 4, expectMaxBits = 128;   // Zones 33-64 not decoded yet
+#endif
+
+// Every zone group command of the PowerSeries panels, in zone order
+const byte allZoneCmd[4] = { 0x27, 0x2d, 0x34, 0x3e };
+
+int main(void)
+  {
+    // ----- Profile -----
+    CHECK(DSC_ZONES == expectZones);
+    CHECK(ZONE_GROUPS == expectGroups);
+    CHECK(sizeof(zoneCmd) == expectGroups);
+    for (byte grp=0;grp<ZONE_GROUPS;grp++) CHECK(zoneCmd[grp] == allZoneCmd[grp]);
+    CHECK(MAX_BITS == expectMaxBits);
+    CHECK(WORD_BITS <= MAX_BITS);
+    CHECK(FRAME_BYTES * 8 >= MAX_BITS + 1);
+
+    // ----- Zone words: decoded for the model's groups only -----
+    for (byte grp=0;grp<4;grp++) {
+      byte data[] = { 0x81, 0x01, 0x91, 0xc7, (byte)(0x05 << grp) };
+      std::string w = panelWord(allZoneCmd[grp], data, sizeof(data));
+      dscFrame_t f;
+      dscPanelInfo_t info;
+      CHECK(dscFrameFromText(f, w.c_str(), w.size()) == (int)w.size());
+      CHECK(dscDecodePanel(f, info) == allZoneCmd[grp]);
+      CHECK(info.crc == 1);
+      if (grp < expectGroups) {
+        CHECK(info.zoneGroup == grp);
+        CHECK(info.zones == (byte)(0x05 << grp));
+      }
+      else {
+        CHECK(info.zoneGroup == ZONE_NONE);
+        CHECK(info.zones == 0);
+      }
+    }
+
+    // ----- Word length: the longest decoded word fits, longer ones are cut -----
+    byte armData[] = { 0x26, 0x2a, 0x55, 0x78, 0x99 };
+    std::string w = panelWord(0xa5, armData, sizeof(armData));
+    dscFrame_t f;
+    dscPanelInfo_t info;
+    CHECK(w.size() <= MAX_BITS);
+    dscFrameFromText(f, w.c_str(), w.size());
+    CHECK(dscDecodePanel(f, info) == 0xa5);
+    CHECK(info.arm == 0x02 && info.user == 1);
+    std::string tooLong(MAX_BITS + 40, '1');
+    CHECK(dscFrameFromText(f, tooLong.c_str(), tooLong.size()) == FRAME_BYTES * 8);
+
+    printf("model %d: %d zone groups, MAX_BITS %d, WORD_BITS %d, frame %d bytes\n",
+           DSC_PANEL, ZONE_GROUPS, MAX_BITS, WORD_BITS, FRAME_BYTES);
+    return testResult("model");
+  }
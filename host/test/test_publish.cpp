@@ -0,0 +1,232 @@
+/* test_publish.cpp
+ * Part of DSC Library
+ * See COPYRIGHT.txt and LICENSE.txt for more information.
+ *
+ * DSCPublisher (DSC_Publish.h) against a loopback Client that parses what it
+ * is sent as an MQTT 3.1.1 broker would: the CONNECT packet, the PUBLISH
+ * packets of the words clocked into the DSC ISR (topic, payload, retain) and
+ * the batching (one write per flush interval).
+ */
+
+#include <vector>
+
+#include "hosttest.h"
+#include <DSC.h>
+#include <DSC_Publish.h>
+
+// ----- Words (DSC_Core.h layout, checksum last) -----
+static const std::string status = "00000101" "0" "10000001" "00000001" "00010000" "10010111";
+static const std::string powerFail = "00000101" "0" "10000001" "00000001" "00011000" "10011111";
+static const std::string zones13 = "00100111" "0" "10000001" "00000001" "10010001" "11000111" "00000101" "00000110";
+static const std::string zonesAll = "00100111" "0" "10000001" "00000001" "10010001" "11000111" "11111111" "00000000";
+static const std::string armed = "10100101" "0" "00100110" "00101010" "01010101" "01111000" "10011001" "01011011";
+static const std::string panicKey = "11101110";
+
+struct Packet
+  {
+    byte type;                    // High nibble of the fixed header
+    byte flags;                   // Low nibble (PUBLISH: retain is bit 0)
+    std::string body;             // Variable header and payload
+    std::string topic, payload;   // PUBLISH
+  };
+
+// Stand-in broker: keeps every write and parses the packets in them
+class Loopback : public Client
+{
+  public:
+    std::vector<std::string> writes;
+    std::vector<Packet> packets;
+    bool framingError = false;
+
+    virtual int connect(IPAddress /*ip*/, uint16_t /*port*/) { return 1; }
+    virtual int connect(const char * /*host*/, uint16_t /*port*/) { return 1; }
+    virtual size_t write(uint8_t c) { return write(&c, 1); }
+    virtual size_t write(const uint8_t *buf, size_t size)
+      {
+        writes.push_back(std::string((const char *)buf, size));
+        stream.append((const char *)buf, size);
+        parse();
+        return size;
+      }
+    using Print::write;
+    virtual int available(void) { return 0; }
+    virtual int read(void) { return -1; }
+    virtual int read(uint8_t * /*buf*/, size_t /*size*/) { return -1; }
+    virtual int peek(void) { return -1; }
+    virtual void flush(void) {}
+    virtual void stop(void) {}
+    virtual uint8_t connected(void) { return 1; }
+    virtual operator bool(void) { return true; }
+
+    // The PUBLISH packets of "topic", in order
+    std::vector<Packet> topic(const char *name)
+      {
+        std::vector<Packet> out;
+        for (auto &p : packets)
+          if (p.type == 3 && p.topic == name) out.push_back(p);
+        return out;
+      }
+
+  private:
+    std::string stream;           // Bytes not parsed yet (a packet split over writes)
+
+    void parse(void)
+      {
+        for (;;) {
+          // Fixed header: type/flags, remaining length (1 to 4 bytes, 7 bits each)
+          size_t pos = 1;
+          unsigned long remaining = 0;
+          int shift = 0;
+          byte b;
+          do {
+            if (pos >= stream.size()) return;
+            b = stream[pos++];
+            remaining |= (unsigned long)(b & 0x7f) << shift;
+            shift += 7;
+          } while ((b & 0x80) && shift < 28);
+          if (stream.size() < pos + remaining) return;
+          Packet p;
+          p.type = (byte)stream[0] >> 4;
+          p.flags = stream[0] & 0x0f;
+          p.body = stream.substr(pos, remaining);
+          if (p.type == 3) {
+            if (p.body.size() < 2) framingError = true;
+            else {
+              size_t len = ((byte)p.body[0] << 8) | (byte)p.body[1];
+              if (2 + len > p.body.size()) framingError = true;
+              else {
+                p.topic = p.body.substr(2, len);
+                p.payload = p.body.substr(2 + len);   // QoS 0, no packet id
+              }
+            }
+          }
+          packets.push_back(p);
+          stream.erase(0, pos + remaining);
+        }
+      }
+};
+
+DSC dsc;
+Loopback broker;
+DSCPublisher pub(broker, "dsc", 512);
+
+// Sends a word (and a keypad word) and publishes what it changed
+static void send(const std::string &p, const std::string &k = "")
+  {
+    busWord(p, k, 500, 6500);
+    dsc.process();
+    pub.update(dsc);
+  }
+
+int main(void)
+  {
+    CHECK(dsc.begin());
+    CHECK(pub.begin() == 512);
+
+    // ----- CONNECT -----
+    CHECK(pub.connect("dsc-test"));
+    CHECK(pub.writeCount == 1);
+    CHECK(broker.packets.size() == 1);
+    const Packet &c = broker.packets[0];
+    CHECK(c.type == 1 && c.flags == 0);
+    CHECK(c.body.size() == 12 + 8);
+    CHECK(c.body.compare(0, 6, std::string("\0\4MQTT", 6)) == 0);
+    CHECK(c.body[6] == 4);                              // Protocol level 3.1.1
+    CHECK(c.body[7] == 0x02);                           // Clean session
+    CHECK(((byte)c.body[8] << 8 | (byte)c.body[9]) == PUB_KEEPALIVE);
+    CHECK(c.body.compare(10, 10, std::string("\0\10dsc-test", 10)) == 0);
+
+    // ----- First state: a full snapshot, batched into one write -----
+    send(zones13);
+    send(powerFail);
+    size_t writes = broker.writes.size();
+    CHECK(pub.writeCount == 1);                         // Still waiting for the interval
+    hostAdvance(PUB_INTERVAL * 1000UL);
+    pub.loop();
+    CHECK(broker.writes.size() == writes + 1);
+    CHECK(!broker.framingError);
+    CHECK(broker.packets.size() == 1 + 8 + 7);          // Every zone of group A, every status
+    for (int i=1;i<=8;i++) {
+      String name = String("dsc/zone/") + String(i);
+      std::vector<Packet> z = broker.topic(name.c_str());
+      CHECK(z.size() == 1);
+      if (z.size() != 1) continue;
+      CHECK(z[0].flags == 0x01);                        // Retained
+      CHECK(z[0].payload == ((i == 1 || i == 3) ? "1" : "0"));
+    }
+    CHECK(broker.topic("dsc/status/ready").size() == 1);
+    CHECK(broker.topic("dsc/status/ready")[0].payload == "1");
+    CHECK(broker.topic("dsc/status/power")[0].payload == "1");  // Power failure
+    CHECK(broker.topic("dsc/status/armed")[0].payload == "0");
+
+    // ----- Changes only -----
+    send(status);                                       // Power back
+    send(zonesAll);                                     // 6 more zones open at once
+    hostAdvance(PUB_INTERVAL * 1000UL);
+    pub.loop();
+    CHECK(broker.writes.size() == writes + 2);          // The whole group in one write
+    CHECK(broker.topic("dsc/status/power").size() == 2);
+    CHECK(broker.topic("dsc/status/power")[1].payload == "0");
+    CHECK(broker.topic("dsc/status/ready").size() == 1);        // Unchanged, not sent
+    CHECK(broker.topic("dsc/zone/1").size() == 1);
+    CHECK(broker.topic("dsc/zone/8").size() == 2);
+    CHECK(broker.topic("dsc/zone/8")[1].payload == "1");
+
+    // ----- Arm (retained) and panic (not retained) -----
+    send(armed);
+    send(status, panicKey);
+    CHECK(pub.flush() > 0);
+    CHECK(broker.topic("dsc/arm").size() == 1);
+    CHECK(broker.topic("dsc/arm")[0].payload == "armed 1");
+    CHECK(broker.topic("dsc/arm")[0].flags == 0x01);
+    CHECK(broker.topic("dsc/alarm").size() == 1);
+    CHECK(broker.topic("dsc/alarm")[0].payload == "panic");
+    CHECK(broker.topic("dsc/alarm")[0].flags == 0x00);
+
+    // ----- Keep alive -----
+    size_t count = broker.packets.size();
+    hostAdvance(PUB_KEEPALIVE * 1000000UL);
+    pub.loop();
+    CHECK(broker.packets.size() == count + 1);
+    CHECK(broker.packets.back().type == 12);            // PINGREQ
+    CHECK(broker.packets.back().body.empty());
+
+    // ----- Two byte remaining length (a topic over 127 bytes) -----
+    static char longPrefix[140];
+    memset(longPrefix, 'p', sizeof(longPrefix) - 1);
+    Loopback broker2;
+    DSCPublisher pub2(broker2, longPrefix, 256);
+    CHECK(pub2.begin() == 256);
+    CHECK(pub2.begin() == 256);                         // Again, the first buffer is freed
+    pub2.setInterval(0);                                // Every message written at once
+    pub2.update(dsc);                                   // The status word and the panic above
+    CHECK(broker2.writes.size() == 1 + 7);
+    CHECK(broker2.packets.size() == 1 + 7);
+    CHECK(!broker2.framingError);
+    std::string alarm = std::string(longPrefix) + "/alarm";
+    CHECK(broker2.topic(alarm.c_str()).size() == 1);
+    for (auto &w : broker2.writes) CHECK((byte)w[1] & 0x80);    // Continuation bit
+
+    // ----- A message bigger than the buffer is dropped, not split -----
+    Loopback broker3;
+    DSCPublisher pub3(broker3, longPrefix, 64);
+    pub3.begin();
+    pub3.update(dsc);
+    CHECK(pub3.dropCount == 1 + 7);
+    CHECK(pub3.flush() == 0);
+    CHECK(broker3.writes.empty());
+
+    // ----- End: the buffer is freed, nothing more is queued -----
+    CHECK(pub2.end() == 1);
+    CHECK(pub2.end() == 0);
+    pub2.update(dsc);
+    CHECK(broker2.writes.size() == 1 + 7);
+    CHECK(pub3.end() == 1);
+    CHECK(pub.end() == 1);
+
+    CHECK(!broker.framingError);
+    CHECK(pub.dropCount == 0);
+    printf("publish: %lu messages in %lu writes, %lu bytes\n",
+           pub.msgCount, pub.writeCount, pub.byteCount);
+    return testResult("publish");
+  }
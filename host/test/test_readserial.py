@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# Runs the readserial.py daemon on a pseudo terminal and checks what it logs
+#
+#   test_readserial.py [golden/DSCPanelSimple.txt]
+#
+# The sketch output (the DSCPanelSimple golden file, with the "\r\n" line ends
+# of Serial.println()) is written to the master side of os.openpty(), the
+# daemon reads the slave side as its serial port. Then the tab separated log
+# must have one row per line of output, and the query socket the last word and
+# message of each command. Exits with 77 (skipped, for ctest) without pyserial.
+
+import json
+import os
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+import tty
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(os.path.dirname(HERE))
+TIMEOUT = 10                # Seconds to wait for the daemon
+
+
+def expected(lines):
+    """The log rows (src, cmd, crc, bits, msg) readserial.py should write."""
+    rows = []
+    last = "panel"
+    for line in lines:
+        if line.startswith("[Panel]") or line.startswith("[Keypad]"):
+            src = "panel" if line.startswith("[Panel]") else "keypad"
+            ok = line.endswith("(OK)")
+            bits = line.split("]", 1)[1].replace("(OK)", "").replace(" ", "")
+            crc = "ok" if ok else ("" if src == "keypad" else "bad")
+            rows.append((src, "%02x" % int(bits[:8], 2), crc, bits, ""))
+            last = src
+        elif line.startswith("---> "):
+            cmd, msg = line[5:7], line.split("): ", 1)[1] if "): " in line else ""
+            rows.append((last + "_msg", cmd, "", "", msg.strip()))
+        else:
+            rows.append(("text", "", "", "", line))
+    return rows
+
+
+def query(path):
+    s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    s.connect(path)
+    data = b""
+    while True:
+        chunk = s.recv(65536)
+        if not chunk:
+            break
+        data += chunk
+    s.close()
+    return json.loads(data.decode())
+
+
+def main():
+    try:
+        import serial       # noqa: F401 (the daemon needs pyserial)
+    except ImportError:
+        print("readserial: skipped, no pyserial")
+        return 77
+
+    golden = sys.argv[1] if len(sys.argv) > 1 else os.path.join(HERE, "golden", "DSCPanelSimple.txt")
+    with open(golden) as f:
+        lines = [l.rstrip("\n") for l in f]
+    rows = expected([l.strip() for l in lines if l.strip()])
+
+    fails = []
+
+    def check(cond, what):
+        if not cond:
+            fails.append(what)
+            print("readserial: %s" % what, file=sys.stderr)
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    tmp = tempfile.mkdtemp(prefix="readserial")
+    log = os.path.join(tmp, "dsc.log")
+    sock = os.path.join(tmp, "dsc.sock")
+    daemon = subprocess.Popen(
+        [sys.executable, os.path.join(ROOT, "readserial.py"), "--port", os.ttyname(slave),
+         "--log", log, "--socket", sock, "--flush", "0.1"],
+        cwd=ROOT, stderr=subprocess.PIPE, universal_newlines=True)
+    try:
+        # The daemon empties the port's input when it opens it, wait for that
+        line = daemon.stderr.readline()
+        check(line.startswith("connected to"), "daemon didn't connect: %r" % line)
+
+        data = "".join(l + "\r\n" for l in lines).encode()
+        for i in range(0, len(data), 512):
+            os.write(master, data[i:i + 512])
+
+        # Every line is a record, the query counts them
+        state = {}
+        deadline = time.time() + TIMEOUT
+        while time.time() < deadline:
+            if os.path.exists(sock):
+                state = query(sock)
+                if sum(state["counts"].values()) >= len(rows):
+                    break
+            time.sleep(0.1)
+        time.sleep(0.3)                 # One more log flush
+        state = query(sock)
+
+        # ----- Query socket -----
+        check(state.get("connected") is True, "not connected in the query")
+        counts = {}
+        for r in rows:
+            counts[r[0]] = counts.get(r[0], 0) + 1
+        check(state.get("counts") == counts, "counts %s, expected %s" % (state.get("counts"), counts))
+        for src, cmd, crc, bits, msg in rows:
+            if src in ("panel", "keypad"):
+                last = [r for r in rows if r[0] == src and r[1] == cmd][-1]
+                got = state["words"].get(src, {}).get(cmd, {})
+                check(got.get("bits") == last[3] and got.get("crc") == last[2],
+                      "last %s word %s: %s" % (src, cmd, got))
+            elif src.endswith("_msg"):
+                last = [r for r in rows if r[0] == src and r[1] == cmd][-1]
+                got = state["messages"].get(src[:-4], {}).get(cmd, {})
+                check(got.get("msg") == last[4], "last %s %s: %s" % (src, cmd, got))
+
+        # ----- Log rows -----
+        with open(log) as f:
+            logged = [l.rstrip("\n").split("\t") for l in f]
+        check(logged[0] == ["time", "src", "cmd", "crc", "bits", "msg"], "log header %s" % logged[0])
+        check(len(logged) - 1 == len(rows), "%d log rows, expected %d" % (len(logged) - 1, len(rows)))
+        for n, (row, exp) in enumerate(zip(logged[1:], rows)):
+            check(len(row) == 6 and float(row[0]) > 0 and tuple(row[1:]) == exp,
+                  "log row %d: %s, expected %s" % (n + 1, row, exp))
+            if len(fails) > 10:
+                break
+    finally:
+        daemon.send_signal(2)           # SIGINT, the daemon closes the log and the socket
+        try:
+            daemon.wait(TIMEOUT)
+        except subprocess.TimeoutExpired:
+            daemon.kill()
+            fails.append("daemon didn't stop")
+        daemon.stderr.close()
+        os.close(master)
+        os.close(slave)
+    check(not os.path.exists(sock), "socket left behind")
+    shutil.rmtree(tmp, ignore_errors=True)
+
+    print("readserial: %d lines, %d log rows: %s" % (len(lines), len(rows), "FAILED" if fails else "passed"))
+    return 1 if fails else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
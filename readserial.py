@@ -1,9 +1,292 @@
-#!/usr/bin/python
+#!/usr/bin/env python3
 # -*- coding: utf-8 -*-
-# Reading the serial data in realtime
+# Reads the serial data from the Arduino and logs it as parsed records
+#
+#   readserial.py [--port /dev/ttyACM0] [--log dsc.log] [--socket /tmp/dsc.sock]
+#       Runs the ingestion daemon: reads the serial port in large chunks, parses
+#       the text output of the example sketches ("[Panel]"/"[Keypad]" words, the
+#       decoded message lines, DSCJson objects) and the binary capture stream of
+#       DSCRecorder, and writes one record per line to a tab separated log that
+#       rotates by size. Reconnects (with backoff) when the port goes away.
+#   readserial.py query [--socket /tmp/dsc.sock]
+#       Prints the last state (last words and messages by command) as JSON
+#
+# Any serial device path works for --port, including the slave of a pseudo
+# terminal (os.openpty()) to feed it recorded output without an Arduino.
 
-import serial
+import argparse
+import json
+import os
+import re
+import selectors
+import socket
+import sys
+import time
 
-ser = serial.Serial("/dev/ttyACM0", 115200)
-while True:
-    print ser.readline()
+import dscrecord
+
+LOG_COLUMNS = ("time", "src", "cmd", "crc", "bits", "msg")
+
+# "[Panel]  00000101 0 10000001 ... (OK)" and "[Keypad] 11111111 ..."
+WORD_RE = re.compile(r"^\[(Panel|Keypad)\]\s+([01 ]+?)\s*(\(OK\))?$")
+# "---> 05(5): Status..." or "12:34:56, 1/2/2017 05(5): Status..."
+MSG_RE = re.compile(r"^(?:---> |\d\d:\d\d:\d\d, \d+/\d+/\d+ )([0-9a-f]{2})\((\d+)\): ?(.*)$")
+
+
+class RotatingLog:
+    """Tab separated log with a header line, rotated to name.1 .. name.N by size."""
+
+    def __init__(self, path, max_bytes, count):
+        self.path = path
+        self.max_bytes = max_bytes
+        self.count = count
+        self.f = None
+        self.open()
+
+    def open(self):
+        new = not os.path.exists(self.path) or os.path.getsize(self.path) == 0
+        self.f = open(self.path, "a", buffering=64 * 1024)
+        if new:
+            self.f.write("\t".join(LOG_COLUMNS) + "\n")
+
+    def write(self, rec):
+        row = [str(rec.get(c, "")).replace("\t", " ") for c in LOG_COLUMNS]
+        self.f.write("\t".join(row) + "\n")
+        if self.f.tell() >= self.max_bytes:
+            self.rotate()
+
+    def rotate(self):
+        self.f.close()
+        for i in range(self.count - 1, 0, -1):
+            src = "%s.%d" % (self.path, i)
+            if os.path.exists(src):
+                os.replace(src, "%s.%d" % (self.path, i + 1))
+        os.replace(self.path, self.path + ".1")
+        self.open()
+
+    def flush(self):
+        self.f.flush()
+
+    def close(self):
+        self.f.close()
+
+
+class Parser:
+    """Splits the serial stream into records (dicts with the LOG_COLUMNS keys)."""
+
+    def __init__(self):
+        self.reset()
+
+    def reset(self):
+        self.buf = b""
+        self.binary = None          # EdgeDecoder once a capture header was seen
+        self.frames = None
+        self.last_src = None        # Source of the last word, for the message line
+
+    def feed(self, data):
+        records = []
+        if self.binary is None:
+            self.buf += data
+            i = self.buf.find(dscrecord.MAGIC)
+            if i >= 0:
+                # The recorder sketch sends nothing but the capture after its header
+                text, data = self.buf[:i], self.buf[i:]
+                self.buf = text + b"\n"
+                records += self.lines()
+                self.binary = dscrecord.EdgeDecoder()
+                self.frames = dscrecord.FrameBuilder()
+            else:
+                return self.lines()
+        for t, clk, dta, overrun in self.binary.feed(data):
+            for src, bits, end in self.frames.edge(t, clk, dta, overrun):
+                records.append(self.word("panel" if src == "P" else "keypad", bits))
+        return records
+
+    def lines(self):
+        *lines, self.buf = self.buf.split(b"\n")
+        if len(self.buf) > 4096:        # No line end, not our output
+            self.buf = b""
+        records = []
+        for raw in lines:
+            line = raw.decode("ascii", "replace").strip()
+            if line:
+                records.append(self.line(line))
+        return records
+
+    def word(self, src, bits, crc=""):
+        self.last_src = src
+        cmd = "%02x" % int(bits[:8], 2) if len(bits) >= 8 else ""
+        return {"src": src, "cmd": cmd, "crc": crc, "bits": bits, "msg": ""}
+
+    def line(self, line):
+        m = WORD_RE.match(line)
+        if m:
+            src = m.group(1).lower()
+            return self.word(src, m.group(2).replace(" ", ""),
+                             "ok" if m.group(3) else ("" if src == "keypad" else "bad"))
+        m = MSG_RE.match(line)
+        if m:
+            return {"src": (self.last_src or "panel") + "_msg", "cmd": m.group(1),
+                    "msg": m.group(3)}
+        if line.startswith("{"):
+            try:
+                obj = json.loads(line)
+                cmd = obj.get("cmd")
+                return {"src": "json_" + str(obj.get("src", "")),
+                        "cmd": "%02x" % cmd if isinstance(cmd, int) else "",
+                        "msg": line}
+            except ValueError:
+                pass
+        return {"src": "text", "msg": line}
+
+
+class State:
+    """Last state for the query socket, the latest record by source and command."""
+
+    def __init__(self):
+        self.words = {}
+        self.messages = {}
+        self.counts = {}
+        self.connected = False
+        self.since = time.time()
+
+    def update(self, rec):
+        src = rec["src"]
+        self.counts[src] = self.counts.get(src, 0) + 1
+        if src in ("panel", "keypad") or src.startswith("json_"):
+            self.words.setdefault(src, {})[rec.get("cmd", "")] = rec
+        elif src.endswith("_msg"):
+            self.messages.setdefault(src[:-4], {})[rec["cmd"]] = rec
+        else:
+            self.messages["text"] = rec
+
+    def dump(self):
+        return json.dumps({"connected": self.connected, "since": self.since,
+                           "counts": self.counts, "words": self.words,
+                           "messages": self.messages}, indent=1, sort_keys=True)
+
+
+def open_port(path, baud):
+    import serial               # pyserial
+    port = serial.Serial(path, baud, timeout=0)
+    port.reset_input_buffer()
+    return port
+
+
+def serve(args):
+    import serial
+
+    log = RotatingLog(args.log, args.log_size, args.log_count)
+    parser = Parser()
+    state = State()
+
+    if os.path.exists(args.socket):
+        os.unlink(args.socket)
+    server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    server.bind(args.socket)
+    server.listen(4)
+    server.setblocking(False)
+
+    sel = selectors.DefaultSelector()
+    sel.register(server, selectors.EVENT_READ, "query")
+    port = None
+    backoff = 1
+    retry_at = 0
+    last_flush = time.time()
+
+    try:
+        while True:
+            now = time.time()
+            if port is None and now >= retry_at:
+                try:
+                    port = open_port(args.port, args.baud)
+                    sel.register(port.fileno(), selectors.EVENT_READ, "serial")
+                    parser.reset()
+                    state.connected = True
+                    backoff = 1
+                    print("connected to %s" % args.port, file=sys.stderr)
+                except (serial.SerialException, OSError) as e:
+                    print("%s, retrying in %d s" % (e, backoff), file=sys.stderr)
+                    retry_at = now + backoff
+                    backoff = min(backoff * 2, args.max_backoff)
+
+            for key, _ in sel.select(timeout=1.0):
+                if key.data == "query":
+                    conn, _ = server.accept()
+                    try:
+                        conn.sendall(state.dump().encode() + b"\n")
+                    except OSError:
+                        pass
+                    conn.close()
+                    continue
+                try:
+                    # Everything waiting in one read, not a line at a time
+                    chunk = port.read(max(1, port.in_waiting))
+                    if not chunk:
+                        raise serial.SerialException("device disconnected")
+                except (serial.SerialException, OSError) as e:
+                    print("%s: %s" % (args.port, e), file=sys.stderr)
+                    sel.unregister(port.fileno())
+                    port.close()
+                    port = None
+                    state.connected = False
+                    retry_at = time.time() + backoff
+                    break
+                stamp = "%.3f" % time.time()
+                for rec in parser.feed(chunk):
+                    rec["time"] = stamp
+                    log.write(rec)
+                    state.update(rec)
+
+            if time.time() - last_flush >= args.flush:
+                log.flush()
+                last_flush = time.time()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        log.close()
+        server.close()
+        os.unlink(args.socket)
+
+
+def query(args):
+    s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        s.connect(args.socket)
+    except OSError as e:
+        sys.exit("%s: %s (is the daemon running?)" % (args.socket, e))
+    data = b""
+    while True:
+        chunk = s.recv(65536)
+        if not chunk:
+            break
+        data += chunk
+    sys.stdout.write(data.decode())
+
+
+def main():
+    parser = argparse.ArgumentParser(description="DSC serial ingestion daemon")
+    parser.add_argument("mode", nargs="?", choices=("serve", "query"), default="serve")
+    parser.add_argument("--port", default="/dev/ttyACM0")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--log", default="dsc.log")
+    parser.add_argument("--log-size", type=int, default=4 * 1024 * 1024,
+                        help="rotate the log at this size (default %(default)s)")
+    parser.add_argument("--log-count", type=int, default=5,
+                        help="rotated logs to keep (default %(default)s)")
+    parser.add_argument("--flush", type=float, default=5,
+                        help="seconds between log flushes (default %(default)s)")
+    parser.add_argument("--max-backoff", type=int, default=30,
+                        help="longest reconnect delay in seconds (default %(default)s)")
+    parser.add_argument("--socket", default="/tmp/dsc.sock",
+                        help="unix socket for the last state query")
+    args = parser.parse_args()
+
+    if args.mode == "query":
+        query(args)
+    else:
+        serve(args)
+
+
+if __name__ == "__main__":
+    main()